@@ -0,0 +1,671 @@
+/**
+ * \file bench_mastermind.c
+ * \brief Microbenchmarks of mastermind game model
+ * \authors Fraiponts Thomas, Schins Martin
+ * \version 0.1
+ * \date 04/05/2024
+ *
+ * INFO0030 : Projet de programmation 4, Mastermind.
+ * Checks first that every feedback kernel supported gives the feedbacks of
+ * the scalar one. Then times the hot paths of the model and prints, for each
+ * of them, the time and the number of allocations per operation, and the
+ * peak resident memory of the process after it ran.
+ *
+ * Must be linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc to
+ * count the allocations.
+ *
+ * Usage: mastermind-bench [-g nbGames] [-m maxScores] [-f filePath]
+ *
+ * */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <math.h>
+#include <sys/resource.h>
+
+#include "model_mastermind.h"
+
+/**
+ * \brief Default number of games played per number of pawns, every secret
+ * being played when there are fewer.
+ */
+#define DEFAULT_BENCH_GAMES 16
+
+/**
+ * \brief Default largest number of scores of the score file benchmarks.
+ */
+#define DEFAULT_BENCH_SCORES 1000000
+
+/**
+ * \brief Default file written by the score file benchmarks.
+ */
+#define DEFAULT_BENCH_PATH "./bench_scores.bin"
+
+/**
+ * \brief Number of feedbacks computed by the feedback benchmark.
+ */
+#define BENCH_FEEDBACKS 1000000
+
+/**
+ * \brief Number of distinct solutions of the feedback benchmark.
+ */
+#define BENCH_SOLUTIONS 4096
+
+/**
+ * \brief Number of models created by the model benchmark.
+ */
+#define BENCH_MODELS 1000
+
+/**
+ * \brief Number of scores of existing players recorded by the record
+ * benchmark.
+ */
+#define BENCH_RECORDS 1000
+
+/**
+ * \brief Number of calls of the scores strings benchmark.
+ */
+#define BENCH_SCORES_STRINGS 10
+
+/**
+ * \brief Maximum number of (proposition, solution) pairs checked per number
+ * of pawns. Up to 5 pawns every pair is checked, above only propositions
+ * spread over every configuration, against every solution.
+ */
+#define BENCH_CHECK_PAIRS 300000000ULL
+
+/**
+ * \brief Minimum number of feedbacks computed by each kernel benchmark.
+ */
+#define BENCH_KERNEL_FEEDBACKS 10000000
+
+/**
+ * \brief Names of the feedback kernels.
+ */
+static const char *KERNEL_NAMES[NB_FEEDBACK_KERNELS] = {"scalar", "avx2"};
+
+/**
+ * \brief Number of allocations done since the start of the program.
+ */
+static unsigned long long nbAllocations = 0;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+/**
+ * \brief Measure of a benchmark in progress.
+ */
+typedef struct {
+   struct timespec start;              /*!< Time at the start */
+   unsigned long long nbAllocations;   /*!< Allocations done before the start */
+} Measure;
+
+
+/**
+ * \fn static void start_measure(Measure *measure)
+ * \brief Starts measuring a benchmark.
+ *
+ * \param measure The measure to start.
+ *
+ * \pre measure != NULL
+ */
+static void start_measure(Measure *measure);
+
+
+/**
+ * \fn static void print_measure(const Measure *measure, const char *name, unsigned int nbPawns, unsigned long long nbOperations)
+ * \brief Prints the results of a benchmark that just ended.
+ *
+ * \param measure The measure started before the benchmark.
+ * \param name The name of the benchmark.
+ * \param nbPawns The number of pawns, 0 if it does not apply.
+ * \param nbOperations The number of operations of the benchmark.
+ *
+ * \pre measure != NULL, name != NULL, nbOperations > 0
+ */
+static void print_measure(const Measure *measure, const char *name,
+                          unsigned int nbPawns,
+                          unsigned long long nbOperations);
+
+
+/**
+ * \fn static ModelMainMenu *create_bench_menu(unsigned int nbPawns)
+ * \brief Creates the settings of the games of the computer with the default
+ * solver, which record no score so that the games time the model alone.
+ *
+ * \param nbPawns The number of pawns.
+ *
+ * \return The main menu model,
+ *         NULL if memory allocation failed.
+ */
+static ModelMainMenu *create_bench_menu(unsigned int nbPawns);
+
+
+/**
+ * \fn static ModelMastermind *create_bench_model(ModelMainMenu *mmm)
+ * \brief Creates a game with the settings of the benchmarks, always with
+ * the same solution.
+ *
+ * \param mmm The settings created by create_bench_menu().
+ *
+ * \pre mmm != NULL
+ *
+ * \return The game model,
+ *         NULL if memory allocation failed.
+ */
+static ModelMastermind *create_bench_model(ModelMainMenu *mmm);
+
+
+/**
+ * \fn static void set_secret(ModelMastermind *mm, unsigned int index)
+ * \brief Selects the solution of a game, and the proposition, by its index
+ * among every configuration, in lexicographic order.
+ *
+ * \param mm A pointer on the game model.
+ * \param index The index of the solution.
+ *
+ * \pre mm != NULL
+ */
+static void set_secret(ModelMastermind *mm, unsigned int index);
+
+
+/**
+ * \fn static bool play_game(ModelMastermind *mm)
+ * \brief Lets the computer find the solution of a game.
+ *
+ * \param mm A pointer on the game model, whose solution is set.
+ *
+ * \pre mm != NULL
+ *
+ * \return true if the solution was found,
+ *         false otherwise.
+ */
+static bool play_game(ModelMastermind *mm);
+
+
+/**
+ * \fn static bool check_kernels(unsigned int nbPawns)
+ * \brief Checks that every feedback kernel supported gives the feedbacks of
+ * the scalar one, and prints the number of pairs checked.
+ *
+ * \param nbPawns The number of pawns.
+ *
+ * \return true if the kernels agree,
+ *         false if one differs or memory allocation failed.
+ */
+static bool check_kernels(unsigned int nbPawns);
+
+
+/**
+ * \fn static bool bench_kernels(unsigned int nbPawns)
+ * \brief Runs the feedback kernel benchmarks, one operation being one
+ * feedback.
+ *
+ * \param nbPawns The number of pawns.
+ *
+ * \return true if success,
+ *         false if memory allocation failed.
+ */
+static bool bench_kernels(unsigned int nbPawns);
+
+
+/**
+ * \fn static bool bench_model(unsigned int nbPawns, unsigned int nbGames)
+ * \brief Runs the feedback, model creation and game benchmarks.
+ *
+ * \param nbPawns The number of pawns.
+ * \param nbGames The number of games played, 0 for every secret.
+ *
+ * \return true if success,
+ *         false if memory allocation failed.
+ */
+static bool bench_model(unsigned int nbPawns, unsigned int nbGames);
+
+
+/**
+ * \fn static void remove_bench_scores(const char *filePath)
+ * \brief Removes a score file, its journal and its lock file.
+ *
+ * \param filePath The path of the score file.
+ *
+ * \pre filePath != NULL
+ */
+static void remove_bench_scores(const char *filePath);
+
+
+/**
+ * \fn static bool bench_scores(unsigned int nbScores, const char *filePath)
+ * \brief Runs the score file, score recording and scores strings
+ * benchmarks.
+ *
+ * \param nbScores The number of players in the score file.
+ * \param filePath The path of the score file written.
+ *
+ * \pre filePath != NULL
+ *
+ * \return true if success,
+ *         false if memory allocation or a file operation failed.
+ */
+static bool bench_scores(unsigned int nbScores, const char *filePath);
+
+
+void *__wrap_malloc(size_t size) {
+   __atomic_add_fetch(&nbAllocations, 1, __ATOMIC_RELAXED);
+   return __real_malloc(size);
+}
+
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+   __atomic_add_fetch(&nbAllocations, 1, __ATOMIC_RELAXED);
+   return __real_calloc(nmemb, size);
+}
+
+
+void *__wrap_realloc(void *ptr, size_t size) {
+   __atomic_add_fetch(&nbAllocations, 1, __ATOMIC_RELAXED);
+   return __real_realloc(ptr, size);
+}
+
+
+static void start_measure(Measure *measure) {
+   measure->nbAllocations = __atomic_load_n(&nbAllocations, __ATOMIC_RELAXED);
+   clock_gettime(CLOCK_MONOTONIC, &measure->start);
+}
+
+
+static void print_measure(const Measure *measure, const char *name,
+                          unsigned int nbPawns,
+                          unsigned long long nbOperations) {
+   struct timespec end;
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   unsigned long long allocations =
+      __atomic_load_n(&nbAllocations, __ATOMIC_RELAXED) -
+      measure->nbAllocations;
+   double nanoseconds = (end.tv_sec - measure->start.tv_sec) * 1e9 +
+                        (end.tv_nsec - measure->start.tv_nsec);
+
+   struct rusage usage;
+   getrusage(RUSAGE_SELF, &usage);
+
+   if(nbPawns > 0)
+      printf("%-26s %5u", name, nbPawns);
+   else
+      printf("%-26s %5s", name, "-");
+   printf(" %10llu %14.1f %10.2f %10ld\n", nbOperations,
+          nanoseconds / nbOperations, (double) allocations / nbOperations,
+          usage.ru_maxrss);
+   fflush(stdout);
+}
+
+
+static ModelMainMenu *create_bench_menu(unsigned int nbPawns) {
+   ModelMainMenu *mmm = create_model_main_menu();
+   if(mmm == NULL)
+      return NULL;
+
+   set_role(mmm, PROPOSER);
+   set_save_scores(mmm, false);
+   set_nb_pawns_slider(mmm, nbPawns);
+
+   return mmm;
+}
+
+
+static ModelMastermind *create_bench_model(ModelMainMenu *mmm) {
+   set_seed(mmm, 0);
+   return create_model_mastermind(mmm);
+}
+
+
+static void set_secret(ModelMastermind *mm, unsigned int index) {
+   unsigned int nbPawns = get_nb_pawns(mm);
+
+   reset_proposition(mm);
+   for(unsigned int i = nbPawns; i > 0; i--){
+      set_selected_color(mm, index % (NB_PAWN_COLORS - 1));
+      set_proposition_pawn_selected_color(mm, i - 1);
+      index /= NB_PAWN_COLORS - 1;
+   }
+
+   set_proposition_as_solution(mm);
+   set_valid_solution_true(mm);
+}
+
+
+static bool play_game(ModelMastermind *mm) {
+   bool found = false;
+
+   find_next_proposition(mm);
+   set_proposition_in_history(mm);
+
+   while(get_in_game(mm)){
+      determine_feedback_proposition(mm, get_proposition(mm), get_solution(mm));
+      set_proposition_in_history(mm);
+
+      unsigned int nbCorrect = get_nb_correct_last_combination(mm);
+      found = nbCorrect == get_nb_pawns(mm);
+      set_last_combination_feedback(mm, nbCorrect,
+                                    get_nb_misplaced_last_combination(mm));
+      verify_end_game(mm);
+      update_current_combination_index(mm);
+
+      if(get_in_game(mm)){
+         find_next_proposition(mm);
+         set_proposition_in_history(mm);
+      }
+   }
+
+   return found;
+}
+
+
+static bool check_kernels(unsigned int nbPawns) {
+   unsigned int nbConfigs = pow(NB_PAWN_COLORS - 1, nbPawns);
+   unsigned int nbPropositions = nbConfigs;
+   if((unsigned long long) nbConfigs * nbConfigs > BENCH_CHECK_PAIRS)
+      nbPropositions = BENCH_CHECK_PAIRS / nbConfigs;
+
+   unsigned char *expected = malloc(nbConfigs);
+   unsigned char *keys = malloc(nbConfigs);
+   if(expected == NULL || keys == NULL){
+      free(expected);
+      free(keys);
+      fprintf(stderr, "Memory allocation failed\n");
+      return false;
+   }
+
+   bool agree = true;
+   for(unsigned int i = 0; i < nbPropositions && agree; i++){
+      // Propositions are spread over every configuration.
+      unsigned int proposition = (unsigned long long) i * nbConfigs /
+                                 nbPropositions;
+      determine_feedback_keys(FEEDBACK_KERNEL_SCALAR, proposition, nbPawns,
+                              expected);
+
+      for(unsigned int kernel = FEEDBACK_KERNEL_SCALAR + 1;
+          kernel < NB_FEEDBACK_KERNELS && agree; kernel++){
+         if(determine_feedback_keys(kernel, proposition, nbPawns, keys) != 0)
+            continue;
+
+         for(unsigned int j = 0; j < nbConfigs && agree; j++){
+            if(keys[j] != expected[j]){
+               fprintf(stderr, "Feedback kernel %s differs from %s with %u "
+                       "pawns, proposition %u, solution %u\n",
+                       KERNEL_NAMES[kernel],
+                       KERNEL_NAMES[FEEDBACK_KERNEL_SCALAR], nbPawns,
+                       proposition, j);
+               agree = false;
+            }
+         }
+      }
+   }
+
+   if(agree)
+      printf("feedback kernels agree with %u pawns on %llu pairs%s\n",
+             nbPawns, (unsigned long long) nbPropositions * nbConfigs,
+             (nbPropositions == nbConfigs) ? ", every pair" : "");
+
+   free(expected);
+   free(keys);
+
+   return agree;
+}
+
+
+static bool bench_kernels(unsigned int nbPawns) {
+   Measure measure;
+   char name[32];
+
+   unsigned int nbConfigs = pow(NB_PAWN_COLORS - 1, nbPawns);
+   unsigned int nbPropositions = BENCH_KERNEL_FEEDBACKS / nbConfigs + 1;
+
+   unsigned char *keys = malloc(nbConfigs);
+   if(keys == NULL)
+      return false;
+
+   for(unsigned int kernel = 0; kernel < NB_FEEDBACK_KERNELS; kernel++){
+      if(!is_feedback_kernel_supported(kernel))
+         continue;
+
+      sprintf(name, "feedback_batch %s", KERNEL_NAMES[kernel]);
+      start_measure(&measure);
+      for(unsigned int i = 0; i < nbPropositions; i++)
+         determine_feedback_keys(kernel, (unsigned long long) i * nbConfigs /
+                                 nbPropositions, nbPawns, keys);
+      print_measure(&measure, name, nbPawns,
+                    (unsigned long long) nbPropositions * nbConfigs);
+   }
+
+   free(keys);
+
+   return true;
+}
+
+
+static bool bench_model(unsigned int nbPawns, unsigned int nbGames) {
+   Measure measure;
+
+   ModelMainMenu *mmm = create_bench_menu(nbPawns);
+   if(mmm == NULL)
+      return false;
+
+   ModelMastermind *mm = create_bench_model(mmm);
+   PAWN_COLOR *solutions = malloc(BENCH_SOLUTIONS * nbPawns *
+                                  sizeof(PAWN_COLOR));
+   if(mm == NULL || solutions == NULL){
+      if(mm != NULL)
+         destroy_model_mastermind(mm);
+      free(solutions);
+      destroy_model_main_menu(mmm);
+      return false;
+   }
+
+   srand(nbPawns);
+   for(unsigned int i = 0; i < BENCH_SOLUTIONS * nbPawns; i++)
+      solutions[i] = rand() % (NB_PAWN_COLORS - 1);
+
+   set_secret(mm, nbPawns);
+   Combination *proposition = get_proposition(mm);
+
+   start_measure(&measure);
+   for(unsigned int i = 0; i < BENCH_FEEDBACKS; i++)
+      determine_feedback_proposition(mm, proposition, solutions +
+                                     (i % BENCH_SOLUTIONS) * nbPawns);
+   print_measure(&measure, "feedback", nbPawns, BENCH_FEEDBACKS);
+
+   destroy_model_mastermind(mm);
+   free(solutions);
+
+   start_measure(&measure);
+   for(unsigned int i = 0; i < BENCH_MODELS; i++){
+      mm = create_bench_model(mmm);
+      if(mm == NULL){
+         destroy_model_main_menu(mmm);
+         return false;
+      }
+      destroy_model_mastermind(mm);
+   }
+   print_measure(&measure, "create_model", nbPawns, BENCH_MODELS);
+
+   unsigned int nbConfigs = pow(NB_PAWN_COLORS - 1, nbPawns);
+   if(nbGames == 0 || nbGames > nbConfigs)
+      nbGames = nbConfigs;
+
+   unsigned int nbFound = 0;
+   start_measure(&measure);
+   for(unsigned int i = 0; i < nbGames; i++){
+      mm = create_bench_model(mmm);
+      if(mm == NULL){
+         destroy_model_main_menu(mmm);
+         return false;
+      }
+
+      // Secrets are spread over every configuration.
+      set_secret(mm, (unsigned long long) i * nbConfigs / nbGames);
+      nbFound += play_game(mm);
+      destroy_model_mastermind(mm);
+   }
+   print_measure(&measure, "game", nbPawns, nbGames);
+
+   destroy_model_main_menu(mmm);
+
+   if(nbFound != nbGames)
+      printf("%u of %u games with %u pawns were lost\n", nbGames - nbFound,
+             nbGames, nbPawns);
+
+   return true;
+}
+
+
+static void remove_bench_scores(const char *filePath) {
+   char journalPath[strlen(filePath) + sizeof(SCORES_JOURNAL_SUFFIX)];
+   char lockPath[strlen(filePath) + sizeof(SCORES_LOCK_SUFFIX)];
+
+   sprintf(journalPath, "%s%s", filePath, SCORES_JOURNAL_SUFFIX);
+   sprintf(lockPath, "%s%s", filePath, SCORES_LOCK_SUFFIX);
+   remove(filePath);
+   remove(journalPath);
+   remove(lockPath);
+}
+
+
+static bool bench_scores(unsigned int nbScores, const char *filePath) {
+   Measure measure;
+   char pseudo[MAX_PSEUDO_LENGTH];
+   char name[32];
+
+   // The players are recorded in a new file.
+   remove_bench_scores(filePath);
+   SavedScores *scores = load_scores(filePath, NULL);
+   if(scores == NULL)
+      return false;
+
+   srand(nbScores);
+   for(unsigned int i = 0; i < nbScores; i++){
+      sprintf(pseudo, "player%07u", i);
+      if(record_score(scores, pseudo, 1 + rand() % 1000) != 0){
+         destroy_saved_scores(scores);
+         return false;
+      }
+   }
+   int status = write_scores(scores);
+   destroy_saved_scores(scores);
+   if(status != 0)
+      return false;
+
+   sprintf(name, "load_scores %u", nbScores);
+   start_measure(&measure);
+   scores = load_scores(filePath, NULL);
+   print_measure(&measure, name, 0, 1);
+   if(scores == NULL)
+      return false;
+
+   // The first score recorded indexes the players.
+   sprintf(name, "first record_score %u", nbScores);
+   start_measure(&measure);
+   if(record_score(scores, "player0000000", 1) != 0){
+      destroy_saved_scores(scores);
+      return false;
+   }
+   print_measure(&measure, name, 0, 1);
+
+   sprintf(name, "record_score %u", nbScores);
+   start_measure(&measure);
+   for(unsigned int i = 0; i < BENCH_RECORDS; i++){
+      sprintf(pseudo, "player%07u", rand() % nbScores);
+      if(record_score(scores, pseudo, 1) != 0){
+         destroy_saved_scores(scores);
+         return false;
+      }
+   }
+   print_measure(&measure, name, 0, BENCH_RECORDS);
+
+   sprintf(name, "write_scores %u", nbScores);
+   start_measure(&measure);
+   status = write_scores(scores);
+   print_measure(&measure, name, 0, 1);
+
+   sprintf(name, "get_scores_strings %u", nbScores);
+   start_measure(&measure);
+   for(unsigned int i = 0; i < BENCH_SCORES_STRINGS; i++){
+      unsigned int length;
+      char **strings = get_scores_strings(scores, &length);
+      free_scores_strings(strings, length);
+   }
+   print_measure(&measure, name, 0, BENCH_SCORES_STRINGS);
+
+   destroy_saved_scores(scores);
+   remove_bench_scores(filePath);
+
+   return status == 0;
+}
+
+
+int main(int argc, char **argv) {
+
+   unsigned int nbGames = DEFAULT_BENCH_GAMES;
+   unsigned int maxScores = DEFAULT_BENCH_SCORES;
+   const char *filePath = DEFAULT_BENCH_PATH;
+   bool validArguments = true;
+
+   for(int i = 1; i < argc && validArguments; i++){
+      if(i + 1 == argc)
+         validArguments = false;
+      else if(!strcmp(argv[i], "-g"))
+         nbGames = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-m"))
+         maxScores = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-f"))
+         filePath = argv[++i];
+      else
+         validArguments = false;
+   }
+
+   if(!validArguments){
+      fprintf(stderr, "Usage: %s [-g nbGames] [-m maxScores] [-f filePath]\n"
+                      "nbGames: games per number of pawns, 0 for every "
+                      "secret.\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   for(unsigned int nbPawns = 1; nbPawns <= MAX_NB_PAWNS; nbPawns++)
+      if(!check_kernels(nbPawns))
+         return EXIT_FAILURE;
+
+   load_opening_book(OPENING_BOOK_PATH);
+
+   printf("%-26s %5s %10s %14s %10s %10s\n", "benchmark", "pawns", "ops",
+          "ns/op", "allocs/op", "peak KiB");
+
+   for(unsigned int nbPawns = MIN_NB_PAWNS; nbPawns <= MAX_NB_PAWNS;
+       nbPawns++){
+      // The smallest game is cheap enough to be played from every secret.
+      if(!bench_kernels(nbPawns) ||
+         !bench_model(nbPawns, (nbPawns == MIN_NB_PAWNS) ? 0 : nbGames)){
+         fprintf(stderr, "Memory allocation failed\n");
+         destroy_feedback_tables();
+         return EXIT_FAILURE;
+      }
+   }
+
+   destroy_feedback_tables();
+
+   for(unsigned int nbScores = 10000; nbScores <= maxScores; nbScores *= 10){
+      if(!bench_scores(nbScores, filePath)){
+         fprintf(stderr, "Score benchmark with %u scores failed\n", nbScores);
+         return EXIT_FAILURE;
+      }
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/**
+ * \file book_mastermind.c
+ * \brief Opening book generator of mastermind game
+ * \authors Fraiponts Thomas, Schins Martin
+ * \version 0.1
+ * \date 04/05/2024
+ *
+ * INFO0030 : Projet de programmation 4, Mastermind.
+ * Precomputes the first and second propositions of every solver and number
+ * of pawns, so that the game only has to look them up.
+ *
+ * Usage: mastermind-book [-w maxWork] [-t nbThreads] [filePath]
+ *
+ * */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "model_mastermind.h"
+
+/**
+ * \brief Default maximum number of feedbacks computed per proposition.
+ */
+#define DEFAULT_BOOK_WORK 1000000000ULL
+
+int main(int argc, char **argv) {
+
+   unsigned long long maxWork = DEFAULT_BOOK_WORK;
+   unsigned int nbThreads = DEFAULT_SOLVER_THREADS;
+   const char *filePath = OPENING_BOOK_PATH;
+
+   for(int i = 1; i < argc; i++){
+      if(!strcmp(argv[i], "-w") && i + 1 < argc)
+         maxWork = strtoull(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-t") && i + 1 < argc)
+         nbThreads = strtoul(argv[++i], NULL, 10);
+      else if(argv[i][0] != '-')
+         filePath = argv[i];
+      else{
+         fprintf(stderr, "Usage: %s [-w maxWork] [-t nbThreads] [filePath]\n",
+                 argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+
+   if(maxWork == 0){
+      fprintf(stderr, "The work budget must be positive\n");
+      return EXIT_FAILURE;
+   }
+
+   ModelMainMenu *mmm = create_model_main_menu();
+   if(mmm == NULL)
+      return EXIT_FAILURE;
+
+   set_solver_threads(mmm, nbThreads);
+   // Games of every size share the tables, which are too large above 4 pawns.
+   set_feedback_table_max_pawns(mmm, DEFAULT_FEEDBACK_TABLE_PAWNS);
+
+   for(unsigned int solver = 0; solver < NB_SOLVERS; solver++){
+      if(solver == SOLVER_FIRST_CONSISTENT)
+         continue;
+
+      set_solver(mmm, solver);
+
+      for(unsigned int nbPawns = MIN_NB_PAWNS; nbPawns <= MAX_NB_PAWNS;
+          nbPawns++){
+         time_t start = time(NULL);
+
+         set_nb_pawns_slider(mmm, nbPawns);
+         if(!generate_opening_book(mmm, maxWork)){
+            fprintf(stderr, "Failed to compute the book of solver %u with %u "
+                            "pawns\n", solver, nbPawns);
+            destroy_model_main_menu(mmm);
+            destroy_feedback_tables();
+            return EXIT_FAILURE;
+         }
+
+         fprintf(stderr, "solver %u, %u pawns: %.0f s\n", solver, nbPawns,
+                 difftime(time(NULL), start));
+      }
+   }
+
+   destroy_model_main_menu(mmm);
+   destroy_feedback_tables();
+
+   if(write_opening_book(filePath) != 0)
+      return EXIT_FAILURE;
+
+   return EXIT_SUCCESS;
+}
@@ -69,6 +69,20 @@ struct controller_mastermind_t {
 static void handle_quit(GtkWidget *button, gpointer data);
 
 
+/**
+ * \fn static void on_score_clicked(GtkWidget *item, gpointer data)
+ * \brief Shows the score window, with the scores saved since the game
+ * started
+ *
+ * \param item pointer on the menu item that was activated
+ * \param data pointer on the ControllerMastermind structure
+ *
+ * \pre item != NULL, data != NULL
+ * \post the score window shows the best scores
+ */
+static void on_score_clicked(GtkWidget *item, gpointer data);
+
+
 ControllerMainMenu *
 create_controller_main_menu(ModelMainMenu *mmm, ViewMainMenu *vmm) {
    assert(mmm != NULL && vmm != NULL);
@@ -194,8 +208,7 @@ create_controller_mastermind(ModelMastermind *mm, ViewMastermind *vm,
 
    for(unsigned int i = 0; i < NB_PAWN_COLORS - 1; i++){
       cm->colorSelectionButtons[i] = create_button_with_pixbuf(
-              get_color_image_pixbuf(vm, i),
-              get_mastermind_color_button_size(vm));
+              get_color_image_pixbuf(vm, i, COLOR_BUTTON));
       if(cm->colorSelectionButtons[i] == NULL){
          free(cm->colorSelectionButtons);
          free(cm->menuBar);
@@ -214,8 +227,7 @@ create_controller_mastermind(ModelMastermind *mm, ViewMastermind *vm,
 
    for(unsigned int i = 0; i < get_nb_pawns(mm); i++){
       cm->propositionButtons[i] = create_button_with_pixbuf(
-              get_color_image_pixbuf(vm, PAWN_DEFAULT),
-              get_mastermind_proposition_button_size(vm));
+              get_color_image_pixbuf(vm, PAWN_DEFAULT, PROPOSITION_BUTTON));
       if(cm->propositionButtons[i] == NULL){
          free(cm->propositionButtons);
          free(cm->colorSelectionButtons);
@@ -235,8 +247,7 @@ create_controller_mastermind(ModelMastermind *mm, ViewMastermind *vm,
 
    for(unsigned int i = 0; i < get_nb_pawns(mm); i++){
       cm->feedbackButtons[i] = create_button_with_pixbuf(
-              get_feedback_image_pixbuf(vm, FB_DEFAULT),
-              get_mastermind_proposition_button_size(vm));
+              get_feedback_image_pixbuf(vm, FB_DEFAULT, PROPOSITION_BUTTON));
       if(cm->feedbackButtons[i] == NULL){
          free(cm->feedbackButtons);
          free(cm->propositionButtons);
@@ -424,7 +435,7 @@ void init_mastermind(ControllerMastermind *cm) {
 
    GtkWidget *window = get_mastermind_window(cm->vm);
    GtkWidget *mainVBox = get_mastermind_main_vbox(cm->vm);
-   GtkWidget *historyTable = get_mastermind_history_table(cm->vm);
+   GtkWidget *historyBoard = get_mastermind_history_board(cm->vm);
    GtkWidget *propositionHBox = get_mastermind_proposition_hbox(cm->vm);
    GtkWidget *propositionControlHBox = get_mastermind_proposition_control_hbox(
            cm->vm);
@@ -440,10 +451,7 @@ void init_mastermind(ControllerMastermind *cm) {
                       get_mastermind_scores_title_label(cm->vm), TRUE, TRUE,
                       10);
 
-   unsigned size = (get_saved_scores_length(cm->mm) < MAX_SCORE_DISPLAYED)
-                   ? get_saved_scores_length(cm->mm) : MAX_SCORE_DISPLAYED;
-
-   for(unsigned i = 0; i < size; i++)
+   for(unsigned i = 0; i < MAX_SCORE_DISPLAYED; i++)
       gtk_box_pack_start(GTK_BOX(scoreMainVBox),
                          get_mastermind_players_scores_label(cm->vm)[i], TRUE,
                          TRUE, 10);
@@ -451,19 +459,10 @@ void init_mastermind(ControllerMastermind *cm) {
    gtk_box_pack_start(GTK_BOX(scoreMainVBox), cm->scoreOkayButton, FALSE, FALSE,
                       10);
 
-   unsigned int nbCombi = get_nb_combinations(cm->mm);
    unsigned int nbPawns = get_nb_pawns(cm->mm);
 
-   for(unsigned int i = 0; i < nbCombi; i++){
-      for(unsigned int j = 0; j < nbPawns; j++){
-         gtk_table_attach_defaults(GTK_TABLE(historyTable),
-                                   get_mastermind_history_combination_button(
-                                           cm->vm, i, j), j, j + 1, i, i + 1);
-         gtk_table_attach(GTK_TABLE(historyTable),
-                          get_mastermind_history_feedback_button(cm->vm, i, j),
-                          nbPawns + j, nbPawns + j + 1, i, i + 1, 0, 0, 0, 0);
-      }
-   }
+   g_signal_connect(G_OBJECT(historyBoard), "expose-event",
+                    G_CALLBACK(on_history_board_expose), cm);
 
    for(unsigned int i = 0; i < nbPawns; i++){
       gtk_box_pack_start(GTK_BOX(propositionHBox), cm->propositionButtons[i],
@@ -492,7 +491,7 @@ void init_mastermind(ControllerMastermind *cm) {
    gtk_container_add(GTK_CONTAINER(scoreWindow), scoreMainVBox);
 
    gtk_container_add(GTK_CONTAINER(mainVBox), cm->menuBar->bar);
-   gtk_container_add(GTK_CONTAINER(mainVBox), historyTable);
+   gtk_container_add(GTK_CONTAINER(mainVBox), historyBoard);
    gtk_container_add(GTK_CONTAINER(mainVBox), propositionHBox);
    gtk_container_add(GTK_CONTAINER(mainVBox), propositionControlHBox);
    gtk_container_add(GTK_CONTAINER(mainVBox), colorSelectionHBox);
@@ -512,7 +511,7 @@ void init_mastermind(ControllerMastermind *cm) {
    g_signal_connect(G_OBJECT(cm->menuBar->itemAbouts), "activate",
                     G_CALLBACK(show_window), aboutsWindow);
    g_signal_connect(G_OBJECT(cm->menuBar->itemScore), "activate",
-                    G_CALLBACK(show_window), scoreWindow);
+                    G_CALLBACK(on_score_clicked), cm);
    g_signal_connect(G_OBJECT(cm->applyButton), "clicked",
                     G_CALLBACK(on_apply_clicked), cm);
    g_signal_connect(G_OBJECT(cm->resetButton), "clicked",
@@ -666,7 +665,7 @@ void on_main_menu_clicked(GtkWidget *button, gpointer data) {
 
    ControllerMastermind *cm = (ControllerMastermind *) data;
 
-   write_scores(get_saved_scores(cm->mm), SAVED_SCORES_PATH);
+   write_scores(get_saved_scores(cm->mm));
 
    hide_window(button, get_mastermind_end_game_window(cm->vm));
    hide_window(button, get_mastermind_window(cm->vm));
@@ -696,6 +695,18 @@ void on_color_picked(GtkWidget *button, gpointer data) {
 }
 
 
+gboolean on_history_board_expose(GtkWidget *board, GdkEventExpose *event,
+                                 gpointer data) {
+   assert(board != NULL && event != NULL && data != NULL);
+
+   ControllerMastermind *cm = (ControllerMastermind *) data;
+
+   draw_history_board(cm->vm, &event->area);
+
+   return TRUE;
+}
+
+
 void on_proposition_button_clicked(GtkWidget *button, gpointer data) {
    assert(button != NULL && data != NULL);
 
@@ -713,9 +724,8 @@ void on_proposition_button_clicked(GtkWidget *button, gpointer data) {
          set_proposition_pawn_selected_color(cm->mm, pawnIndex);
          apply_pixbufs_to_button(button, get_color_image_pixbuf(cm->vm,
                                                                 get_selected_color(
-                                                                        cm->mm)),
-                                 get_mastermind_proposition_button_size(
-                                         cm->vm));
+                                                                        cm->mm),
+                                                                PROPOSITION_BUTTON));
       }
    }
 }
@@ -740,9 +750,8 @@ void reset_proposition_buttons(ControllerMastermind *cm) {
    if(cm != NULL)
       for(unsigned int i = 0; i < get_nb_pawns(cm->mm); ++i)
          apply_pixbufs_to_button(cm->propositionButtons[i],
-                                 get_color_image_pixbuf(cm->vm, PAWN_DEFAULT),
-                                 get_mastermind_proposition_button_size(
-                                         cm->vm));
+                                 get_color_image_pixbuf(cm->vm, PAWN_DEFAULT,
+                                                        PROPOSITION_BUTTON));
 }
 
 
@@ -750,9 +759,8 @@ void reset_feedback_buttons(ControllerMastermind *cm) {
    if(cm != NULL)
       for(unsigned int i = 0; i < get_nb_pawns(cm->mm); ++i)
          apply_pixbufs_to_button(cm->feedbackButtons[i],
-                                 get_feedback_image_pixbuf(cm->vm, FB_DEFAULT),
-                                 get_mastermind_proposition_button_size(
-                                         cm->vm));
+                                 get_feedback_image_pixbuf(cm->vm, FB_DEFAULT,
+                                                           PROPOSITION_BUTTON));
 }
 
 
@@ -808,6 +816,9 @@ void on_apply_clicked(GtkWidget *button, gpointer data) {
          }
       }
 
+      // The history changes of this click are drawn in a single frame.
+      redraw_history_board(cm->vm);
+
       char new_label[MAX_PSEUDO_LENGTH];
       sprintf(new_label, "Score: %d", 9 - get_current_index(cm->mm));
       set_score_label_text(get_mastermind_score_label(cm->vm), new_label);
@@ -834,17 +845,27 @@ void on_feedback_button_clicked(GtkWidget *button, gpointer data) {
       apply_pixbufs_to_button(button, get_feedback_image_pixbuf(cm->vm,
                                                                 get_feedback_pawn(
                                                                         cm->mm,
-                                                                        pawnIndex)),
-                              get_mastermind_proposition_button_size(cm->vm));
+                                                                        pawnIndex),
+                                                                PROPOSITION_BUTTON));
    }
 }
 
+static void on_score_clicked(GtkWidget *item, gpointer data) {
+   assert(item != NULL && data != NULL);
+
+   ControllerMastermind *cm = (ControllerMastermind *) data;
+
+   update_mastermind_scores_labels(cm->vm);
+   show_window(item, get_mastermind_score_window(cm->vm));
+}
+
+
 static void handle_quit(GtkWidget *button, gpointer data) {
    assert(button != NULL && data != NULL);
 
    ControllerMastermind *cm = (ControllerMastermind *) data;
 
-   write_scores(get_saved_scores(cm->mm), SAVED_SCORES_PATH);
+   write_scores(get_saved_scores(cm->mm));
 
    ModelMastermind *mm = cm->mm;
    ViewMastermind *vm = cm->vm;
@@ -311,6 +311,20 @@ void on_main_menu_clicked(GtkWidget *button, gpointer data);
 void on_color_picked(GtkWidget *button, gpointer data);
 
 
+/**
+ * \fn gboolean on_history_board_expose(GtkWidget *board, GdkEventExpose *event, gpointer data)
+ * \brief Callback function to draw the exposed area of the history board
+ *
+ * \param board The GtkWidget drawing area of the history
+ * \param event The expose event, giving the area to draw
+ * \param data a pointer to ControllerMastermind structure.
+ *
+ * \return TRUE, the area is drawn
+ */
+gboolean on_history_board_expose(GtkWidget *board, GdkEventExpose *event,
+                                 gpointer data);
+
+
 /**
  * \fn void on_save_button_clicked(GtkWidget *button, gpointer data)
  * \brief Callback function to handle the "Save" button click.
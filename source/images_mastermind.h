@@ -0,0 +1,44 @@
+/**
+ * \file images_mastermind.h
+ * \brief Images embedded in the mastermind game
+ * \authors Fraiponts Thomas, Schins Martin
+ * \version 0.1
+ * \date 06/05/2024
+ *
+ * INFO0030 : Projet de programmation 4, Mastermind.
+ * The images of the game, decoded at build time by mastermind-pack in
+ * images_mastermind.c, so that the game neither reads nor decodes files.
+ *
+ * */
+
+#ifndef __IMAGES_MASTERMIND__
+#define __IMAGES_MASTERMIND__
+
+#include <stdint.h>
+
+/**
+ * \brief Number of bytes of a pixel of an embedded image.
+ */
+#define IMAGE_ASSET_CHANNELS 4
+
+/**
+ * \brief Image decoded at build time.
+ */
+typedef struct {
+   const char *name;       /*!< Path of the file the image was decoded from */
+   unsigned int width;     /*!< Width of the image, in pixels */
+   unsigned int height;    /*!< Height of the image, in pixels */
+   const uint8_t *pixels;  /*!< RGBA rows of width * IMAGE_ASSET_CHANNELS bytes */
+} ImageAsset;
+
+/**
+ * \brief Images embedded in the game, generated by mastermind-pack.
+ */
+extern const ImageAsset IMAGE_ASSETS[];
+
+/**
+ * \brief Number of images in IMAGE_ASSETS.
+ */
+extern const unsigned int NB_IMAGE_ASSETS;
+
+#endif //__IMAGES_MASTERMIND__
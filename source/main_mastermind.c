@@ -22,6 +22,9 @@ int main(int argc, char **argv) {
 
    gtk_init(&argc, &argv);
 
+   // Without a book, the solvers search their first propositions.
+   load_opening_book(OPENING_BOOK_PATH);
+
    // Create main menu model.
    ModelMainMenu *mmm = create_model_main_menu();
    if(mmm == NULL)
@@ -50,6 +53,8 @@ int main(int argc, char **argv) {
    destroy_controller_main_menu(cmm);
    destroy_view_main_menu(vmm);
    destroy_model_main_menu(mmm);
+   destroy_view_assets();
+   destroy_feedback_tables();
 
    return EXIT_SUCCESS;
 }
@@ -10,29 +10,170 @@
  * 
  * */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
 #include <time.h>
 #include <math.h>
+#include <errno.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "model_mastermind.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+
+/**
+ * \brief Defined if the AVX2 feedback kernel is compiled.
+ */
+#define FEEDBACK_SIMD
+#endif
+
+/**
+ * \brief Number of bits used to store one pawn in a packed code.
+ */
+#define PAWN_BITS 3
+
+/**
+ * \brief Mask of the bits of one pawn in a packed code.
+ */
+#define PAWN_MASK 0x7
+
+/**
+ * \brief Number of colors a computer configuration can use (default excluded).
+ */
+#define NB_CONFIG_COLORS (NB_PAWN_COLORS - 1)
+
+/**
+ * \brief Number of distinct feedback keys (see get_feedback_key()).
+ */
+#define NB_FEEDBACK_KEYS ((MAX_NB_PAWNS + 1) * (MAX_NB_PAWNS + 1))
+
+/**
+ * \brief Number of solutions scored at once by determine_feedback_batch().
+ */
+#define FEEDBACK_BLOCK 256
+
+/**
+ * \brief Maximum number of first propositions distinct up to symmetry.
+ */
+#define MAX_NB_OPENERS 32
+
+/**
+ * \brief Maximum number of feedbacks a solver computes to find a proposition.
+ *
+ * Above it, the candidate propositions are restricted to the survivors, then
+ * sampled evenly, so that a turn stays interactive.
+ */
+#define SOLVER_MAX_WORK 40000000ULL
+
+/**
+ * \brief Minimum number of feedbacks of a search before it uses threads.
+ */
+#define SOLVER_MIN_THREADED_WORK 1000000ULL
+
+/**
+ * \brief Number of chunks of candidates per solver thread.
+ */
+#define SOLVER_CHUNKS_PER_THREAD 16
+
+/**
+ * \brief Magic number starting the score file, read in the native byte order.
+ */
+#define SCORES_FILE_MAGIC 0x53434d4du
+
+/**
+ * \brief Version of the score file format.
+ */
+#define SCORES_FILE_VERSION 3
+
+/**
+ * \brief Number of score records of a new score file.
+ */
+#define SCORES_FILE_MIN_CAPACITY 64
+
+/**
+ * \brief Magic number starting the score journal.
+ */
+#define SCORES_JOURNAL_MAGIC 0x4a434d4du
+
+/**
+ * \brief Version of the score journal format.
+ */
+#define SCORES_JOURNAL_VERSION 1
+
+/**
+ * \brief Suffix of the files written before being renamed over the score
+ * file or journal.
+ */
+#define SCORES_TEMPORARY_SUFFIX ".tmp"
+
+/**
+ * \brief Suffix of the path a score file that cannot be read is moved to.
+ */
+#define SCORES_INVALID_SUFFIX ".invalid"
+
+/**
+ * \brief Number of journal records above which write_scores() compacts the
+ * journal into the score file.
+ */
+#define SCORES_JOURNAL_MAX_RECORDS 4096
+
+/**
+ * \brief Time during which the score writer gathers changes before writing
+ * them, in milliseconds.
+ */
+#define SCORES_WRITE_DELAY_MS 200
+
+/**
+ * \brief Maximum time destroy_saved_scores() waits for the score writer to
+ * save the last changes, in milliseconds.
+ */
+#define SCORES_FLUSH_TIMEOUT_MS 5000
+
+/**
+ * \brief Minimum number of slots of the pseudo index of the scores.
+ */
+#define SCORES_INDEX_MIN_CAPACITY 64
+
+/**
+ * \brief Flag of the opening book entries holding a packed proposition.
+ */
+#define BOOK_ENTRY_SET 0x80000000u
+
+/**
+ * \brief Maximum length of a line of the opening book file.
+ */
+#define BOOK_LINE_LENGTH 64
+
 struct combination_t {
-   unsigned int nbCorrect;   /*!< Number of correctly placed pawns with correct color in the combination */
-   unsigned int nbMisplaced; /*!< Number of wrongly placed pawns with correct color in the combination */
-   PAWN_COLOR *pawns;        /*!< Combination of pawns */
+   uint8_t nbCorrect;            /*!< Number of correctly placed pawns with correct color in the combination */
+   uint8_t nbMisplaced;          /*!< Number of wrongly placed pawns with correct color in the combination */
+   uint8_t pawns[MAX_NB_PAWNS];  /*!< PAWN_COLOR of each pawn of the combination */
 };
 
 
+/*
+ * The combinations are stored column by column, packed like the
+ * configurations of the solver, so that checking a configuration against
+ * the history reads a few contiguous bytes.
+ */
 struct history_t {
-   unsigned int nbPawns;         /*!< Number of pawns of a combination */
-   unsigned int nbCombinations;  /*!< Number of combinations in the histroy */
-   int currentIndex;             /*!< Index of the last combination in the history */
-   Combination **combinations;   /*!< History of combinations proposed by the guesser */
+   unsigned int nbPawns;                  /*!< Number of pawns of a combination */
+   unsigned int nbCombinations;           /*!< Number of combinations in the histroy */
+   int currentIndex;                      /*!< Index of the last combination in the history */
+   uint32_t codes[NB_COMBINATIONS];       /*!< Packed combinations proposed by the guesser */
+   uint8_t nbCorrect[NB_COMBINATIONS];    /*!< Number of correctly placed pawns of each combination */
+   uint8_t nbMisplaced[NB_COMBINATIONS];  /*!< Number of misplaced pawns of each combination */
 };
 
 
@@ -41,14 +182,20 @@ struct model_mastermind_t {
    char savedPseudo[MAX_PSEUDO_LENGTH];   /*!< Player pseudo */
    bool inGame;                           /*!< State of the game */
    PAWN_COLOR selectedColor;              /*!< Selected color */
-   Combination *proposition;              /*!< Guesser proposition */
+   Combination proposition;               /*!< Guesser proposition */
    bool validSolution;                    /*!< Validity of the solution */
-   PAWN_COLOR *solution;                  /*!< Proposer combination */
-   History *history;                      /*!< Combinations settings and history */
-   FEEDBACK_COLOR *feedback;              /*!< Player feedback given to computer */
+   PAWN_COLOR solution[MAX_NB_PAWNS];     /*!< Proposer combination */
+   History history;                       /*!< Combinations settings and history */
+   FEEDBACK_COLOR feedback[MAX_NB_PAWNS]; /*!< Player feedback given to computer */
    unsigned int nbConfigs;                /*!< Total of possible combinations */
-   unsigned int lastConfigIndex;          /*!< Index of last combination proposed by the compute */
-   Combination **configs;                 /*!< All the possible configurations */
+   uint32_t *survivors;                   /*!< Packed configurations consistent with every feedback */
+   unsigned int nbSurvivors;              /*!< Number of configurations in survivors */
+   SOLVER solver;                         /*!< Strategy used to find the computer propositions */
+   unsigned int nbSolverThreads;          /*!< Number of threads used by the solver */
+   unsigned int feedbackTableMaxPawns;    /*!< Maximum number of pawns using a feedback table */
+   unsigned long long solverMaxWork;      /*!< Maximum number of feedbacks computed to find a proposition */
+   bool useOpeningBook;                   /*!< Whether the first propositions come from the opening book */
+   uint32_t randomState;                  /*!< State of the generator of the random solution */
    SavedScores *save;                     /*!< Structure containing the previously saved scores */
 };
 
@@ -58,77 +205,208 @@ struct model_main_menu_t {
    bool validPseudo;                /*!< State of pseudo validity */
    ROLE role;                       /*!< Player role */
    unsigned int nbPawns;            /*!< Number of pawns selected */
+   SOLVER solver;                   /*!< Solver selected */
+   unsigned int nbSolverThreads;    /*!< Number of solver threads, 0 for automatic */
+   unsigned int feedbackTableMaxPawns; /*!< Maximum number of pawns using a feedback table */
+   unsigned int seed;               /*!< Seed of the random solution of the next game */
+   SavedScores *scores;             /*!< Scores shared by the games, NULL until the first one */
+   bool saveScores;                 /*!< Whether the games record the scores */
 };
 
-struct score_t {
-   char pseudo[MAX_PSEUDO_LENGTH]; /*!< Saved player pseudo */
-   unsigned score;                 /*!< Score of saved player */
-};
+/**
+ * \brief Search of the proposition giving the best feedback partition.
+ */
+typedef struct {
+   SOLVER solver;                /*!< Criterion used to score a partition */
+   unsigned int nbPawns;         /*!< Number of pawns of the configurations */
+   const uint32_t *candidates;   /*!< Candidate propositions, NULL for every configuration */
+   unsigned int nbCandidates;    /*!< Number of candidate propositions */
+   const uint32_t *secrets;      /*!< Possible secrets, NULL for every configuration */
+   unsigned int nbSecrets;       /*!< Number of possible secrets */
+   const uint8_t *feedbackTable; /*!< Feedback keys of every pair of configurations, or NULL */
+   const uint32_t *secretIndexes; /*!< Indexes of the secrets if feedbackTable and secrets are set */
+   unsigned int nbConfigs;       /*!< Number of configurations (row length of feedbackTable) */
+} GuessSearch;
 
-struct saved_scores_t {
-   unsigned length;                /*!< Number of scores saved */
-   Score **savedScores;            /*!< Saved score from players */
+
+/**
+ * \brief Best proposition found by a GuessSearch.
+ */
+typedef struct {
+   bool found;                   /*!< Whether a proposition was scored */
+   uint32_t proposition;         /*!< Best packed proposition */
+   unsigned int index;           /*!< Index of the proposition in the candidates */
+   double score;                 /*!< Score of its partition, the lower the better */
+   bool isSecret;                /*!< Whether the proposition can be the secret */
+} GuessChoice;
+
+
+/**
+ * \brief Thread scoring chunks of candidates of a shared GuessSearch.
+ */
+typedef struct {
+   const GuessSearch *search;    /*!< Shared search */
+   pthread_mutex_t *lock;        /*!< Lock of nextCandidate */
+   unsigned int *nextCandidate;  /*!< Index of the next candidate to score */
+   unsigned int chunkSize;       /*!< Number of candidates taken at once */
+   GuessChoice best;             /*!< Best proposition found by this thread */
+} GuessWorker;
+
+
+/**
+ * \brief Precomputed first and second propositions of a solver.
+ *
+ * Entries are packed propositions or'ed with BOOK_ENTRY_SET, 0 if missing.
+ */
+typedef struct {
+   uint32_t first[MAX_NB_PAWNS + 1];                     /*!< First proposition, by number of pawns */
+   uint32_t second[MAX_NB_PAWNS + 1][NB_FEEDBACK_KEYS];  /*!< Second proposition, by number of pawns and feedback key of the first one */
+} OpeningBook;
+
+
+/**
+ * \brief Opening books of the solvers, filled by load_opening_book() or
+ * generate_opening_book() before any game starts.
+ */
+static OpeningBook openingBooks[NB_SOLVERS];
+
+/**
+ * \brief Feedback tables already built, by number of pawns (see get_feedback_table()).
+ */
+static uint8_t *feedbackTables[MAX_FEEDBACK_TABLE_PAWNS + 1];
+
+/**
+ * \brief Lock of feedbackTables.
+ */
+static pthread_mutex_t feedbackTablesLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * \brief Lock taken with the lock of a score file, since the locks of the
+ * file are shared by the threads of the process.
+ */
+static pthread_mutex_t scoresFilesLock = PTHREAD_MUTEX_INITIALIZER;
+
+
+struct score_t {
+   char pseudo[MAX_PSEUDO_LENGTH + 1]; /*!< Saved player pseudo */
+   uint32_t score;                     /*!< Score of saved player */
 };
 
+/**
+ * \brief Header of the score file, followed by capacity Score records.
+ */
+typedef struct {
+   uint32_t magic;       /*!< SCORES_FILE_MAGIC */
+   uint32_t version;     /*!< SCORES_FILE_VERSION */
+   uint32_t recordSize;  /*!< Size of a Score record */
+   uint32_t generation;  /*!< Number of compactions of the journal, 0 without file */
+   uint32_t length;      /*!< Number of scores saved */
+   uint32_t capacity;    /*!< Number of records the file holds */
+   uint32_t nbTop;       /*!< Number of records in top */
+   uint32_t top[MAX_SCORE_DISPLAYED]; /*!< Indexes of the best records, best first */
+} ScoresHeader;
 
 /**
- * \fn static Combination *create_combination(unsigned int nbPawns)
- * \brief Allocates memory for Combination structure and returns a pointer to Combination.
- * 
- * \param nbPawns Number of pawns of a combination. 
- * 
- * @post The memory for a Combination structure is allocated.
- * 
- * \return combination a pointer to Combination,
- *         NULL in case of error.
- * 
- * */
-static Combination *create_combination(unsigned int nbPawns);
+ * \brief Header of the score files of version 1, followed by capacity Score
+ * records, without top scores.
+ */
+typedef struct {
+   uint32_t magic;       /*!< SCORES_FILE_MAGIC */
+   uint32_t version;     /*!< 1 */
+   uint32_t recordSize;  /*!< Size of a Score record */
+   uint32_t length;      /*!< Number of scores saved */
+   uint32_t capacity;    /*!< Number of records the file holds */
+   uint32_t reserved[3]; /*!< Zero */
+} ScoresHeaderV1;
 
+/**
+ * \brief Header of the score files of version 2, followed by capacity Score
+ * records, without journal.
+ */
+typedef struct {
+   uint32_t magic;       /*!< SCORES_FILE_MAGIC */
+   uint32_t version;     /*!< 2 */
+   uint32_t recordSize;  /*!< Size of a Score record */
+   uint32_t length;      /*!< Number of scores saved */
+   uint32_t capacity;    /*!< Number of records the file holds */
+   uint32_t nbTop;       /*!< Number of records in top */
+   uint32_t top[MAX_SCORE_DISPLAYED]; /*!< Indexes of the best records, best first */
+} ScoresHeaderV2;
 
 /**
- * \fn static void destroy_combination(Combination *combination)
- * \brief Free the memory allocated to a Combination structure.
- * 
- * \param combination a valid pointer to Combination.
- * 
- * @pre combination != NULL.
- * @post The memory for the Combination structure is freed.
- * 
- * */
-static void destroy_combination(Combination *combination);
+ * \brief Slot of the open-addressing index of the scores by pseudo.
+ */
+typedef struct {
+   uint32_t hash;          /*!< Hash of the pseudo of the record */
+   uint32_t record;        /*!< Index of the record plus one, 0 if the slot is empty */
+} ScoreSlot;
 
+/**
+ * \brief Header of the score journal, followed by JournalRecord records.
+ */
+typedef struct {
+   uint32_t magic;       /*!< SCORES_JOURNAL_MAGIC */
+   uint32_t version;     /*!< SCORES_JOURNAL_VERSION */
+   uint32_t recordSize;  /*!< Size of a JournalRecord */
+   uint32_t generation;  /*!< Generation of the score file the journal applies to */
+} JournalHeader;
 
 /**
- * \fn static History *create_history(unsigned int nbPawns, unsigned int
- * nbCombinations)
- * \brief Allocates memory for History structure and returns a pointer
- * to History.
- * 
- * \param nbPawns Number of pawns of a combination.
- * \param nbCombinations Number of combinations that the player can propose during the game.
- * 
- * \post The memory for a History structure is allocated.
- * 
- * \return history a pointer to History,
- *         NULL in case of error.
- * 
- * */
-static History *
-create_history(unsigned int nbPawns, unsigned int nbCombinations);
+ * \brief Score change appended to the score journal.
+ */
+typedef struct {
+   char pseudo[MAX_PSEUDO_LENGTH + 1]; /*!< Pseudo of the player */
+   uint32_t delta;                     /*!< Points added to the score */
+   int64_t timestamp;                  /*!< Time of the change */
+   uint32_t checksum;                  /*!< Checksum of the record, see checksum_journal_record() */
+} JournalRecord;
+
+struct saved_scores_t {
+   char *filePath;         /*!< Path of the score file */
+   char *journalPath;      /*!< Path of the score journal */
+   int lockFd;             /*!< Lock file of the score file and journal, -1 if not open */
+   FILE *journal;          /*!< Journal opened for reading and appending, NULL if it could not be */
+   long journalOffset;     /*!< Offset of the first journal record not applied to the scores */
+   uint32_t nbJournalRecords; /*!< Number of records in the journal */
+   void *memory;           /*!< Header followed by the records */
+   size_t memorySize;      /*!< Size of memory */
+   bool mapped;            /*!< Whether memory is a private mapping of the score file, or allocated */
+   ScoresHeader *header;   /*!< Header of the scores, in memory */
+   Score *records;         /*!< Saved scores from players, in memory */
+   ScoreSlot *index;       /*!< Index of the records by pseudo, NULL until a score is recorded */
+   uint32_t indexCapacity; /*!< Number of slots of index, a power of two */
+   uint32_t nbIndexed;     /*!< Number of first records in index */
+   unsigned long nbChanges; /*!< Number of changes of the scores, see get_scores_changes() */
+   pthread_mutex_t lock;   /*!< Lock of the scores in memory and of the writer state below */
+   pthread_cond_t wakeUp;  /*!< Signals pending changes or a request to the writer */
+   pthread_cond_t stopped; /*!< Signals that the writer saved everything and stopped */
+   pthread_t writer;       /*!< Thread saving the changes, see run_scores_writer() */
+   bool writerRunning;     /*!< Whether writer was started */
+   bool flushRequested;    /*!< Whether the pending changes must be saved without delay */
+   bool stopping;          /*!< Whether the writer must stop once the changes are saved */
+   bool writerStopped;     /*!< Whether the writer stopped */
+   bool detached;          /*!< Whether the writer frees the structure when it stops */
+   bool failed;            /*!< Whether saving changes failed since the last write_scores() */
+   JournalRecord *pending; /*!< Changes not handed to the journal yet */
+   uint32_t nbPending;     /*!< Number of records in pending */
+   uint32_t pendingCapacity; /*!< Number of records pending holds */
+   JournalRecord *batch;   /*!< Changes being saved, swapped with pending */
+   uint32_t batchCapacity; /*!< Number of records batch holds */
+};
 
 
 /**
- * \fn static void destroy_history(History *history)
- * \brief Free the memory allocated to a History structure.
- * 
+ * \fn static void init_history(History *history, unsigned int nbPawns)
+ * \brief Initialises an empty history of NB_COMBINATIONS combinations.
+ *
  * \param history a valid pointer to History.
- * 
- * \pre history != NULL.
- * \post The memory for the History structure is freed.
- * 
- * */
-static void destroy_history(History *history);
+ * \param nbPawns Number of pawns of a combination.
+ *
+ * \pre history != NULL, nbPawns <= MAX_NB_PAWNS
+ * \post The combinations are PAWN_DEFAULT pawns without feedback and the
+ * current index is the first combination played.
+ */
+static void init_history(History *history, unsigned int nbPawns);
 
 
 /**
@@ -138,398 +416,2860 @@ static void destroy_history(History *history);
  * \param mm Pointer to the ModelMastermind
  *
  * \pre mm != NULL
- * \post The score of the game is updated.
+ * \post The score of the game is updated, unless the game records no score.
  */
 static void update_score(ModelMastermind *mm);
 
 
 /**
- * \fn static Combination **create_configs(unsigned int nbConfigs, unsigned int nbPawns)
- * \brief Allocates memory for an array of configurations.
+ * \fn static uint32_t mix_seed(unsigned int seed)
+ * \brief Scrambles a seed into a non-zero state of next_random().
  *
- * \param nbConfigs The number of configurations to create.
- * \param nbPawns The number of pawns in each configuration.
+ * Close seeds give unrelated states.
  *
- * \post Memory is allocated for the array of configurations.
+ * \param seed The seed.
  *
- * \return A pointer to the array of configurations,
- *         NULL in case of error.
+ * \return The random state.
  */
-static Combination **create_configs(unsigned int nbConfigs, unsigned int nbPawns);
+static uint32_t mix_seed(unsigned int seed);
 
 
 /**
- * \fn static int compare_scores(const void *a, const void *b)
- * \brief comparison between scores used for qsort
+ * \fn static uint32_t next_random(uint32_t *state)
+ * \brief Draws the next number of a xorshift generator.
  *
- * \param a pointer on the first Score element
- * \param b pointer on the second Score element
+ * \param state The non-zero state of the generator, updated.
  *
- * \pre a != NULL, b != NULL
- * \post returns expected value depending on a and b
+ * \pre state != NULL, *state != 0
  *
- * \return 1 if a->score > b->score
- *         -1 if a->score < b->score
- *         0 if a->score = b->score
+ * \return The random number.
  */
-static int compare_scores(const void *a, const void *b);
+static uint32_t next_random(uint32_t *state);
 
 
 /**
- * \fn void destroy_configs(Combination **configs, unsigned int nbConfigs)
- * \brief Destroys an array of combinations and frees the memory allocated for it.
+ * \fn static uint32_t decode_config(unsigned int index, unsigned int nbPawns)
+ * \brief Decodes the packed configuration of the given index.
  *
- * This function destroys an array of combinations and frees the memory allocated for it,
- * including the combinations themselves.
+ * Configurations are numbered in lexicographic order: the index is read in
+ * base NB_CONFIG_COLORS, the first pawn being the most significant digit.
+ * Every configuration is stored on PAWN_BITS bits per pawn, the first pawn
+ * in the lowest bits.
  *
- * \param configs An array of pointers to Combination structures.
- * \param nbConfigs The number of configurations in the array.
+ * \param index The index of the configuration.
+ * \param nbPawns The number of pawns in the configuration.
  *
- * \pre configs != NULL, nbConfigs is the correct number of configurations
+ * \pre nbPawns <= MAX_NB_PAWNS
  *
- * \post The memory allocated for the array of combinations and the combinations themselves is freed.
+ * \return The packed configuration.
  */
-static void destroy_configs(Combination **configs, unsigned int nbConfigs);
+static uint32_t decode_config(unsigned int index, unsigned int nbPawns);
 
 
-static Combination *create_combination(unsigned int nbPawns) {
-   Combination *combination = malloc(sizeof(Combination));
-   if(combination == NULL)
-      return NULL;
+/**
+ * \fn static unsigned int encode_config(uint32_t config, unsigned int nbPawns)
+ * \brief Gives the index of a packed configuration (see decode_config()).
+ *
+ * \param config A packed configuration.
+ * \param nbPawns The number of pawns in the configuration.
+ *
+ * \return The index of the configuration.
+ */
+static unsigned int encode_config(uint32_t config, unsigned int nbPawns);
 
-   combination->nbCorrect = 0;
-   combination->nbMisplaced = 0;
 
-   combination->pawns = malloc(nbPawns * sizeof(PAWN_COLOR));
-   if(combination->pawns == NULL){
-      free(combination);
-      return NULL;
-   }
+/**
+ * \fn static uint32_t next_config(uint32_t config, unsigned int nbPawns)
+ * \brief Gives the packed configuration following the given one.
+ *
+ * \param config A packed configuration.
+ * \param nbPawns The number of pawns in the configuration.
+ *
+ * \pre nbPawns <= MAX_NB_PAWNS
+ *
+ * \return The next configuration in lexicographic order (the last one wraps
+ *         to the first one).
+ */
+static uint32_t next_config(uint32_t config, unsigned int nbPawns);
 
-   for(unsigned int i = 0; i < nbPawns; i++)
-      combination->pawns[i] = PAWN_DEFAULT;
 
-   return combination;
-}
+/**
+ * \fn static bool is_consistent_config(ModelMastermind *mm, uint32_t config)
+ * \brief Checks a configuration against every feedback of the history.
+ *
+ * \param mm A valid pointer to ModelMastermind structure.
+ * \param config A packed configuration.
+ *
+ * \pre mm != NULL
+ *
+ * \return true if config would have given every feedback of the history,
+ *         false if not.
+ */
+static bool is_consistent_config(ModelMastermind *mm, uint32_t config);
 
 
-static void destroy_combination(Combination *combination) {
-   if(combination != NULL){
-      if(combination->pawns != NULL)
-         free(combination->pawns);
-      free(combination);
-   }
-}
+/**
+ * \fn static void filter_survivors(ModelMastermind *mm, uint32_t played, unsigned int nbCorrect, unsigned int nbMisplaced)
+ * \brief Keeps only the survivors consistent with the feedback of a combination.
+ *
+ * The first call enumerates every configuration, the next ones only filter
+ * the remaining survivors in place.
+ * The combination must be the one at the current index of the history.
+ *
+ * \param mm A valid pointer to ModelMastermind structure.
+ * \param played The packed last combination of the history.
+ * \param nbCorrect The number of correctly placed pawns of the combination.
+ * \param nbMisplaced The number of misplaced pawns of the combination.
+ *
+ * \pre mm != NULL
+ * \post The survivors are consistent with the feedback of the combination.
+ *       If the memory allocation fails, survivors stays NULL.
+ */
+static void filter_survivors(ModelMastermind *mm, uint32_t played,
+                             unsigned int nbCorrect, unsigned int nbMisplaced);
 
 
-static History *
-create_history(unsigned int nbPawns, unsigned int nbCombinations) {
-   History *history = malloc(sizeof(History));
-   if(history == NULL)
-      return NULL;
+/**
+ * \fn static bool find_first_consistent(ModelMastermind *mm, uint32_t *proposition)
+ * \brief Finds the first configuration consistent with the history.
+ *
+ * \param mm A valid pointer to ModelMastermind structure.
+ * \param proposition Receives the packed configuration.
+ *
+ * \pre mm != NULL, proposition != NULL
+ *
+ * \return true if a configuration was found,
+ *         false if the history is contradictory.
+ */
+static bool find_first_consistent(ModelMastermind *mm, uint32_t *proposition);
 
-   history->nbPawns = nbPawns;
-   history->nbCombinations = nbCombinations;
-   history->currentIndex = nbCombinations - 1;
 
-   history->combinations = malloc(nbCombinations * sizeof(Combination *));
-   if(history->combinations == NULL){
-      free(history);
-      return NULL;
-   }
+/**
+ * \fn static bool find_best_proposition(ModelMastermind *mm, uint32_t *proposition)
+ * \brief Finds the proposition whose feedback partition of the survivors is
+ * the best for the solver of the model.
+ *
+ * \param mm A valid pointer to ModelMastermind structure.
+ * \param proposition Receives the packed proposition.
+ *
+ * \pre mm != NULL, proposition != NULL
+ *
+ * \return true if a proposition was found,
+ *         false if there is no survivor or memory allocation failed.
+ */
+static bool find_best_proposition(ModelMastermind *mm, uint32_t *proposition);
 
-   for(unsigned int i = 0; i < nbCombinations; i++){
-      history->combinations[i] = create_combination(nbPawns);
-      if(history->combinations[i] == NULL){
-         destroy_history(history);
-         return NULL;
-      }
+
+/**
+ * \fn static bool find_book_proposition(ModelMastermind *mm, uint32_t *proposition)
+ * \brief Looks up the next proposition in the opening book of the solver.
+ *
+ * The second proposition is only used if the first one came from the book.
+ *
+ * \param mm A valid pointer to ModelMastermind structure.
+ * \param proposition Receives the packed proposition.
+ *
+ * \pre mm != NULL, proposition != NULL
+ *
+ * \return true if the book holds the proposition,
+ *         false otherwise.
+ */
+static bool find_book_proposition(ModelMastermind *mm, uint32_t *proposition);
+
+
+/**
+ * \fn static bool parse_book_code(const char *pawns, unsigned int nbPawns, uint32_t *code)
+ * \brief Parses a proposition of the opening book file, one digit per pawn.
+ *
+ * \param pawns The digits of the pawn colors.
+ * \param nbPawns The expected number of pawns.
+ * \param code Receives the packed proposition.
+ *
+ * \pre pawns != NULL, code != NULL
+ *
+ * \return true if the proposition is valid,
+ *         false otherwise.
+ */
+static bool
+parse_book_code(const char *pawns, unsigned int nbPawns, uint32_t *code);
+
+
+/**
+ * \fn static void format_book_code(uint32_t code, unsigned int nbPawns, char *pawns)
+ * \brief Writes a packed proposition as one digit per pawn.
+ *
+ * \param code The packed proposition.
+ * \param nbPawns The number of pawns.
+ * \param pawns Receives the nbPawns digits and the terminating '\\0'.
+ *
+ * \pre pawns != NULL, nbPawns <= MAX_NB_PAWNS
+ */
+static void format_book_code(uint32_t code, unsigned int nbPawns, char *pawns);
+
+
+/**
+ * \fn static unsigned int create_openers(unsigned int nbPawns, uint32_t *openers)
+ * \brief Creates one first proposition for every pattern of colors.
+ *
+ * Before any feedback, permuting the colors or the positions of a
+ * proposition gives an equivalent proposition, so only the partitions of
+ * nbPawns in at most NB_CONFIG_COLORS parts need to be scored. Patterns with
+ * the most colors come first.
+ *
+ * \param nbPawns The number of pawns.
+ * \param openers Array of MAX_NB_OPENERS receiving the packed propositions.
+ *
+ * \pre openers != NULL, nbPawns <= MAX_NB_PAWNS
+ *
+ * \return The number of propositions created.
+ */
+static unsigned int create_openers(unsigned int nbPawns, uint32_t *openers);
+
+
+/**
+ * \fn static void search_guess(const GuessSearch *search, unsigned int begin, unsigned int end, GuessChoice *best)
+ * \brief Scores the candidates of a search in [begin, end[.
+ *
+ * Minimax stops counting a partition as soon as it is worse than the best one.
+ * On equal scores, a candidate that can be the secret is preferred, then the
+ * first one.
+ *
+ * \param search The search.
+ * \param begin Index of the first candidate to score.
+ * \param end Index after the last candidate to score.
+ * \param best The best proposition so far, updated.
+ *
+ * \pre search != NULL, best != NULL, end <= search->nbCandidates
+ */
+static void search_guess(const GuessSearch *search, unsigned int begin,
+                         unsigned int end, GuessChoice *best);
+
+
+/**
+ * \fn static bool run_guess_search(const GuessSearch *search, unsigned int nbThreads, GuessChoice *best)
+ * \brief Scores every candidate of a search, spread over threads.
+ *
+ * Each thread takes chunks of candidates and keeps its own partition and
+ * best proposition, which are merged at the end. The result does not depend
+ * on the number of threads.
+ *
+ * \param search The search.
+ * \param nbThreads The maximum number of threads.
+ * \param best Receives the best proposition.
+ *
+ * \pre search != NULL, best != NULL, nbThreads > 0
+ *
+ * \return true if a proposition was found,
+ *         false if not.
+ */
+static bool run_guess_search(const GuessSearch *search, unsigned int nbThreads,
+                             GuessChoice *best);
+
+
+/**
+ * \fn static void *run_guess_worker(void *data)
+ * \brief Thread function of a GuessWorker.
+ *
+ * \param data A valid pointer to GuessWorker structure.
+ *
+ * \pre data != NULL
+ * \post The best proposition of the chunks taken is in the worker.
+ *
+ * \return NULL
+ */
+static void *run_guess_worker(void *data);
+
+
+/**
+ * \fn static bool is_better_choice(const GuessChoice *choice, const GuessChoice *best)
+ * \brief Compares two propositions: lower score, then proposition that can be
+ * the secret, then lower candidate index.
+ *
+ * \param choice A found proposition.
+ * \param best The best proposition so far.
+ *
+ * \pre choice != NULL, best != NULL
+ *
+ * \return true if choice is better than best,
+ *         false if not.
+ */
+static bool is_better_choice(const GuessChoice *choice, const GuessChoice *best);
+
+
+/**
+ * \fn static double score_partition(SOLVER solver, const unsigned int *partition, unsigned int worst)
+ * \brief Scores a feedback partition, the lower the better.
+ *
+ * \param solver The solver criterion.
+ * \param partition Number of secrets for each feedback key.
+ * \param worst Size of the biggest part.
+ *
+ * \pre partition != NULL
+ *
+ * \return The score of the partition.
+ */
+static double
+score_partition(SOLVER solver, const unsigned int *partition, unsigned int worst);
+
+
+/**
+ * \fn static void determine_feedback_batch(uint32_t proposition, const uint32_t *solutions, unsigned int nbSolutions, unsigned int nbPawns, uint8_t *keys)
+ * \brief Determines the feedback keys of a proposition against many solutions.
+ *
+ * Uses the AVX2 (with BMI2) kernel if the processor supports it, the scalar
+ * one otherwise.
+ *
+ * \param proposition The packed proposition.
+ * \param solutions The packed solutions.
+ * \param nbSolutions The number of solutions.
+ * \param nbPawns The number of pawns of the codes.
+ * \param keys Receives the nbSolutions feedback keys (see get_feedback_key()).
+ *
+ * \pre solutions != NULL, keys != NULL
+ */
+static void
+determine_feedback_batch(uint32_t proposition, const uint32_t *solutions,
+                         unsigned int nbSolutions, unsigned int nbPawns,
+                         uint8_t *keys);
+
+
+/**
+ * \fn static void determine_feedback_batch_scalar(uint32_t proposition, const uint32_t *solutions, unsigned int nbSolutions, unsigned int nbPawns, uint8_t *keys)
+ * \brief Scalar kernel of determine_feedback_batch().
+ */
+static void
+determine_feedback_batch_scalar(uint32_t proposition, const uint32_t *solutions,
+                                unsigned int nbSolutions, unsigned int nbPawns,
+                                uint8_t *keys);
+
+
+#ifdef FEEDBACK_SIMD
+/**
+ * \fn static void determine_feedback_batch_avx2(uint32_t proposition, const uint32_t *solutions, unsigned int nbSolutions, unsigned int nbPawns, uint8_t *keys)
+ * \brief AVX2 kernel of determine_feedback_batch(), four solutions at once.
+ */
+static void
+determine_feedback_batch_avx2(uint32_t proposition, const uint32_t *solutions,
+                              unsigned int nbSolutions, unsigned int nbPawns,
+                              uint8_t *keys);
+
+
+/**
+ * \fn static uint64_t expand_code(uint32_t code, unsigned int nbPawns, uint8_t padding)
+ * \brief Expands a packed code to one byte per pawn, pawn i in byte i.
+ *
+ * \param code The packed code.
+ * \param nbPawns The number of pawns.
+ * \param padding The value of the bytes after the last pawn.
+ *
+ * \return The expanded code.
+ */
+static uint64_t expand_code(uint32_t code, unsigned int nbPawns, uint8_t padding);
+#endif
+
+
+/**
+ * \fn static const uint8_t *get_feedback_table(unsigned int nbPawns)
+ * \brief Gives the feedback table of a number of pawns, built on first use.
+ *
+ * Entry i * 7^nbPawns + j is the feedback key of configuration i proposed
+ * against configuration j (see get_feedback_key()). Tables are shared by
+ * every game until destroy_feedback_tables().
+ *
+ * \param nbPawns The number of pawns.
+ *
+ * \pre nbPawns <= MAX_FEEDBACK_TABLE_PAWNS
+ *
+ * \return The feedback table,
+ *         NULL if memory allocation failed.
+ */
+static const uint8_t *get_feedback_table(unsigned int nbPawns);
+
+
+/**
+ * \fn static uint64_t count_colors(uint32_t code, unsigned int nbPawns)
+ * \brief Counts the pawns of each color of a packed code.
+ *
+ * \param code The packed code.
+ * \param nbPawns The number of pawns.
+ *
+ * \return The counts, one byte per color (byte i for color i).
+ */
+static uint64_t count_colors(uint32_t code, unsigned int nbPawns);
+
+
+/**
+ * \fn static unsigned int get_feedback_key(uint32_t proposition, uint64_t propositionColors, uint32_t solution, uint64_t solutionColors, unsigned int nbPawns)
+ * \brief Determines the feedback of a packed proposition as a single key.
+ *
+ * The key is nbCorrect * (MAX_NB_PAWNS + 1) + nbMisplaced.
+ *
+ * \param proposition The packed proposition.
+ * \param propositionColors The color counts of the proposition.
+ * \param solution The packed solution.
+ * \param solutionColors The color counts of the solution.
+ * \param nbPawns The number of pawns of the codes.
+ *
+ * \return The feedback key, lower than NB_FEEDBACK_KEYS.
+ */
+static unsigned int
+get_feedback_key(uint32_t proposition, uint64_t propositionColors,
+                 uint32_t solution, uint64_t solutionColors,
+                 unsigned int nbPawns);
+
+
+/**
+ * \fn static uint32_t pack_pawns(const uint8_t *pawns, unsigned int nbPawns)
+ * \brief Packs the pawns of a combination in a code of PAWN_BITS bits per
+ * pawn.
+ *
+ * \param pawns The pawns to pack.
+ * \param nbPawns The number of pawns.
+ *
+ * \pre pawns != NULL, nbPawns <= MAX_NB_PAWNS
+ *
+ * \return The packed code.
+ */
+static uint32_t pack_pawns(const uint8_t *pawns, unsigned int nbPawns);
+
+
+/**
+ * \fn static uint32_t pack_solution(const PAWN_COLOR *solution, unsigned int nbPawns)
+ * \brief Packs a solution in a code of PAWN_BITS bits per pawn.
+ *
+ * \param solution The pawns to pack.
+ * \param nbPawns The number of pawns.
+ *
+ * \pre solution != NULL, nbPawns <= MAX_NB_PAWNS
+ *
+ * \return The packed code.
+ */
+static uint32_t pack_solution(const PAWN_COLOR *solution, unsigned int nbPawns);
+
+
+/**
+ * \fn static void unpack_code(uint32_t code, unsigned int nbPawns, uint8_t *pawns)
+ * \brief Unpacks a packed code in an array of pawns.
+ *
+ * \param code The packed code.
+ * \param nbPawns The number of pawns.
+ * \param pawns The array receiving the pawns.
+ *
+ * \pre pawns != NULL
+ * \post pawns contains the nbPawns pawns of the code.
+ */
+static void unpack_code(uint32_t code, unsigned int nbPawns, uint8_t *pawns);
+
+
+/**
+ * \fn static void determine_feedback_code(uint32_t proposition, uint32_t solution, unsigned int nbPawns, unsigned int *nbCorrect, unsigned int *nbMisplaced)
+ * \brief Determines the feedback of a packed proposition against a packed solution.
+ *
+ * \param proposition The packed proposition.
+ * \param solution The packed solution.
+ * \param nbPawns The number of pawns of the codes.
+ * \param nbCorrect Receives the number of correctly placed pawns.
+ * \param nbMisplaced Receives the number of misplaced pawns.
+ *
+ * \pre nbCorrect != NULL, nbMisplaced != NULL
+ * \post The feedback is written in nbCorrect and nbMisplaced.
+ */
+static void determine_feedback_code(uint32_t proposition, uint32_t solution,
+                                    unsigned int nbPawns,
+                                    unsigned int *nbCorrect,
+                                    unsigned int *nbMisplaced);
+
+
+/**
+ * \fn static char *create_path(const char *path, const char *suffix)
+ * \brief Allocates the concatenation of a path and a suffix.
+ *
+ * \param path The path.
+ * \param suffix The suffix.
+ *
+ * \pre path != NULL, suffix != NULL
+ *
+ * \return The new path,
+ *         NULL if memory allocation failed.
+ */
+static char *create_path(const char *path, const char *suffix);
+
+
+/**
+ * \fn static int grow_scores(SavedScores *scores)
+ * \brief Moves the scores to allocated memory holding twice more records.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL
+ * \post The capacity is doubled, or unchanged if an error was encountered.
+ *
+ * \return 0 if success
+ *         -1 if memory allocation failed
+ */
+static int grow_scores(SavedScores *scores);
+
+
+/**
+ * \fn static int apply_score(SavedScores *scores, const char *pseudo, unsigned points)
+ * \brief Adds points to the score of a player in memory only.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param pseudo The pseudo of the player.
+ * \param points The number of points to add.
+ *
+ * \pre scores != NULL, pseudo != NULL
+ *
+ * \return 0 if success
+ *         -1 if memory allocation failed, scores is then unchanged
+ */
+static int apply_score(SavedScores *scores, const char *pseudo, unsigned points);
+
+
+/**
+ * \fn static uint32_t checksum_journal_record(const JournalRecord *record)
+ * \brief Computes the checksum of a journal record, which detects the
+ * records torn by a crash.
+ *
+ * \param record The record, whose padding bytes are zero.
+ *
+ * \pre record != NULL
+ *
+ * \return The FNV-1a hash of the record with a zero checksum field.
+ */
+static uint32_t checksum_journal_record(const JournalRecord *record);
+
+
+/**
+ * \fn static int lock_scores_file(SavedScores *scores)
+ * \brief Waits for the exclusive lock of the score file and its journal,
+ * shared by every process using them.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL
+ * \post The score file is locked, unless an error was encountered.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the lock file
+ */
+static int lock_scores_file(SavedScores *scores);
+
+
+/**
+ * \fn static void unlock_scores_file(SavedScores *scores)
+ * \brief Releases the lock taken by lock_scores_file().
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ */
+static void unlock_scores_file(SavedScores *scores);
+
+
+/**
+ * \fn static void set_scores_memory(SavedScores *scores, void *memory, size_t memorySize, bool mapped)
+ * \brief Replaces the memory holding the header and the records of the
+ * scores, releasing the previous one.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param memory The header followed by its records.
+ * \param memorySize The size of memory.
+ * \param mapped Whether memory is a mapping of the score file.
+ *
+ * \pre scores != NULL, memory != NULL
+ * \post The scores are those of memory, their index is empty.
+ */
+static void set_scores_memory(SavedScores *scores, void *memory,
+                              size_t memorySize, bool mapped);
+
+
+/**
+ * \fn static int create_empty_scores(SavedScores *scores)
+ * \brief Starts empty scores at generation 0, in place of the current ones.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL
+ * \post The scores are empty, or unchanged if an error was encountered.
+ *
+ * \return 0 if success
+ *         -1 if memory allocation failed
+ */
+static int create_empty_scores(SavedScores *scores);
+
+
+/**
+ * \fn static int map_scores(SavedScores *scores)
+ * \brief Maps the score file in memory in place of the current scores, or
+ * starts empty scores at generation 0 if there is no file.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The scores are those of the file, or unchanged if the file is not
+ * a score file of this version or an error was encountered.
+ *
+ * \return 0 if success
+ *         1 if the file is not a score file of this version
+ *         -1 Error manipulating the file or memory allocation failed
+ */
+static int map_scores(SavedScores *scores);
+
+
+/**
+ * \fn static int upgrade_scores(SavedScores *scores)
+ * \brief Reads a score file of a previous version in place of the current
+ * scores, rebuilding their top scores, and saves them in a score file of
+ * this version.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The scores are those of the file if success, unchanged if the file
+ * is not a score file of a previous version.
+ *
+ * \return 0 if success
+ *         1 if the file is not a score file of a previous version
+ *         -1 Error manipulating the files or memory allocation failed
+ */
+static int upgrade_scores(SavedScores *scores);
+
+
+/**
+ * \fn static int recover_scores(SavedScores *scores)
+ * \brief Upgrades a score file that map_scores() cannot read if it is of a
+ * previous version. Otherwise, moves it aside (its path followed by
+ * SCORES_INVALID_SUFFIX) and starts empty scores, so that the games can
+ * still be played.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The scores are those of the upgraded file, or empty with the file
+ * moved aside.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the file or memory allocation failed
+ */
+static int recover_scores(SavedScores *scores);
+
+
+/**
+ * \fn static int import_text_scores(SavedScores *scores, const char *textPath)
+ * \brief Adds the scores of a text score file of the previous versions to
+ * the scores, then writes them in a new score file so that they are only
+ * imported once.
+ *
+ * The text file holds the number of scores, then a line per player with its
+ * pseudo and its score. The scores read before an invalid line are kept.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param textPath The path of the text score file.
+ *
+ * \pre scores != NULL, textPath != NULL, the scores are empty, the score
+ * file is locked
+ * \post The scores of the text file are saved, if there is one.
+ *
+ * \return 0 if success, or if there is no text file
+ *         -1 Error manipulating the files or memory allocation failed
+ */
+static int import_text_scores(SavedScores *scores, const char *textPath);
+
+
+/**
+ * \fn static int read_journal(SavedScores *scores, JournalRecord **records, uint32_t *nbRecords)
+ * \brief Reads the journal records following the last one read. The
+ * records following a torn one are dropped.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param records Receives the records read, to free.
+ * \param nbRecords Receives the number of records read.
+ *
+ * \pre scores != NULL, records != NULL, nbRecords != NULL, the journal is
+ * open, the score file is locked
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the journal or memory allocation failed
+ */
+static int read_journal(SavedScores *scores, JournalRecord **records,
+                        uint32_t *nbRecords);
+
+
+/**
+ * \fn static int replay_journal(SavedScores *scores)
+ * \brief Applies the journal of the score file to the scores just mapped,
+ * and opens it, or starts a new journal if there is none for this
+ * generation of the score file.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The journal is replayed and opened.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the journal or memory allocation failed
+ */
+static int replay_journal(SavedScores *scores);
+
+
+/**
+ * \fn static int sync_journal(SavedScores *scores)
+ * \brief Applies the changes other processes appended to the journal. If
+ * another process compacted the journal, the new score file is loaded and
+ * the pending changes applied again.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The scores hold every change saved in the files.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the files or memory allocation failed
+ */
+static int sync_journal(SavedScores *scores);
+
+
+/**
+ * \fn static int reset_journal(SavedScores *scores, uint32_t generation)
+ * \brief Atomically replaces the journal by an empty one for the given
+ * generation of the score file, and opens it.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param generation The generation of the score file.
+ *
+ * \pre scores != NULL, the score file is locked
+ * \post The journal is empty, or closed if an error was encountered.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the journal
+ */
+static int reset_journal(SavedScores *scores, uint32_t generation);
+
+
+/**
+ * \fn static int compact_scores(SavedScores *scores, const ScoresHeader *snapshot)
+ * \brief Writes a snapshot of the scores in a new generation of the score
+ * file, renamed over the previous one, then starts a new journal.
+ *
+ * A crash leaves either the previous score file with its journal, or the
+ * new one, whose generation the previous journal does not apply to.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param snapshot A copy of the header of the scores followed by their
+ * records, taken with the changes of the journal.
+ *
+ * \pre scores != NULL, snapshot != NULL, the score file is locked
+ * \post The journal is empty and the score file holds every score.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the files
+ */
+static int compact_scores(SavedScores *scores, const ScoresHeader *snapshot);
+
+
+/**
+ * \fn static int flush_pending_scores(SavedScores *scores)
+ * \brief Appends the pending changes to the journal and syncs it, or
+ * compacts the journal if it has become too long. The changes of the other
+ * processes are applied first, under the lock of the score file.
+ *
+ * Only the writer, or the owner of the scores if there is no writer, saves
+ * the changes. The lock is only held to take the changes, so that the scores
+ * can be updated while they are written.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the lock of scores is not held
+ * \post The changes pending when called are saved, unless an error was
+ * encountered.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the files
+ */
+static int flush_pending_scores(SavedScores *scores);
+
+
+/**
+ * \fn static void *run_scores_writer(void *data)
+ * \brief Saves the changes recorded in the scores, gathering those made
+ * within SCORES_WRITE_DELAY_MS in one write, until asked to stop.
+ *
+ * \param data A pointer on the SavedScores structure.
+ *
+ * \pre data != NULL
+ * \post Every change is saved, and the scores are freed if the writer was
+ * detached.
+ *
+ * \return NULL
+ */
+static void *run_scores_writer(void *data);
+
+
+/**
+ * \fn static void get_deadline(unsigned int delayMs, struct timespec *deadline)
+ * \brief Computes the time, for pthread_cond_timedwait(), in a delay.
+ *
+ * \param delayMs The delay, in milliseconds.
+ * \param deadline Receives the time at the end of the delay.
+ *
+ * \pre deadline != NULL
+ */
+static void get_deadline(unsigned int delayMs, struct timespec *deadline);
+
+
+/**
+ * \fn static void free_saved_scores(SavedScores *scores)
+ * \brief Frees the scores, without saving them.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL, the writer is not running
+ * \post The memory of scores is freed.
+ */
+static void free_saved_scores(SavedScores *scores);
+
+
+/**
+ * \fn static uint32_t hash_pseudo(const char *pseudo)
+ * \brief Hashes the characters of a pseudo kept in a score record.
+ *
+ * \param pseudo The pseudo.
+ *
+ * \pre pseudo != NULL
+ *
+ * \return The FNV-1a hash of the first MAX_PSEUDO_LENGTH characters.
+ */
+static uint32_t hash_pseudo(const char *pseudo);
+
+
+/**
+ * \fn static void insert_score_slot(ScoreSlot *index, uint32_t capacity, uint32_t hash, uint32_t record)
+ * \brief Inserts a record in the first free slot of its probe sequence.
+ *
+ * \param index The slots.
+ * \param capacity The number of slots, a power of two.
+ * \param hash The hash of the pseudo of the record.
+ * \param record The index of the record.
+ *
+ * \pre index != NULL, index has a free slot
+ */
+static void insert_score_slot(ScoreSlot *index, uint32_t capacity,
+                              uint32_t hash, uint32_t record);
+
+
+/**
+ * \fn static int update_score_index(SavedScores *scores)
+ * \brief Indexes the records that are not yet, the index growing
+ * geometrically to stay at most half full.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ *
+ * \pre scores != NULL
+ * \post Every record is indexed, or the index is unchanged if an error was
+ * encountered.
+ *
+ * \return 0 if success
+ *         -1 if memory allocation failed
+ */
+static int update_score_index(SavedScores *scores);
+
+
+/**
+ * \fn static void update_top_scores(SavedScores *scores, uint32_t record)
+ * \brief Moves a record whose score increased in the best scores of the
+ * header.
+ *
+ * Scores never decrease, so the records out of the top can only enter it
+ * when their own score increases.
+ *
+ * \param scores A pointer on the SavedScores structure.
+ * \param record The index of the record.
+ *
+ * \pre scores != NULL, record < number of scores
+ * \post The top holds the best scores, sorted by compare_scores().
+ */
+static void update_top_scores(SavedScores *scores, uint32_t record);
+
+
+/**
+ * \fn static int compare_scores(const void *a, const void *b)
+ * \brief comparison between scores, with the qsort convention
+ *
+ * \param a pointer on the first Score * element
+ * \param b pointer on the second Score * element
+ *
+ * \pre a != NULL, b != NULL
+ * \post returns expected value depending on a and b
+ *
+ * \return a negative value if a ranks before b: higher score, or same
+ *         score and lower pseudo
+ *         a positive value if a ranks after b
+ *         0 if a and b have the same score and pseudo
+ */
+static int compare_scores(const void *a, const void *b);
+
+
+static void init_history(History *history, unsigned int nbPawns) {
+   assert(history != NULL && nbPawns <= MAX_NB_PAWNS);
+
+   uint32_t empty = 0;
+   for(unsigned int i = 0; i < nbPawns; i++)
+      empty |= (uint32_t) PAWN_DEFAULT << (i * PAWN_BITS);
+
+   history->nbPawns = nbPawns;
+   history->nbCombinations = NB_COMBINATIONS;
+   history->currentIndex = NB_COMBINATIONS - 1;
+   for(unsigned int i = 0; i < NB_COMBINATIONS; i++){
+      history->codes[i] = empty;
+      history->nbCorrect[i] = 0;
+      history->nbMisplaced[i] = 0;
+   }
+}
+
+
+static uint32_t mix_seed(unsigned int seed) {
+   uint32_t state = seed;
+
+   state = (state ^ (state >> 16)) * 0x45d9f3bu;
+   state = (state ^ (state >> 16)) * 0x45d9f3bu;
+   state ^= state >> 16;
+
+   return (state != 0) ? state : 0x9e3779b9u;
+}
+
+
+static uint32_t next_random(uint32_t *state) {
+   assert(state != NULL && *state != 0);
+
+   *state ^= *state << 13;
+   *state ^= *state >> 17;
+   *state ^= *state << 5;
+
+   return *state;
+}
+
+
+static uint32_t decode_config(unsigned int index, unsigned int nbPawns) {
+   assert(nbPawns <= MAX_NB_PAWNS);
+
+   uint32_t config = 0;
+   for(int i = nbPawns - 1; i >= 0; i--){
+      config |= (uint32_t) (index % NB_CONFIG_COLORS) << (i * PAWN_BITS);
+      index /= NB_CONFIG_COLORS;
+   }
+
+   return config;
+}
+
+
+static unsigned int encode_config(uint32_t config, unsigned int nbPawns) {
+   unsigned int index = 0;
+
+   for(unsigned int i = 0; i < nbPawns; i++)
+      index = index * NB_CONFIG_COLORS + ((config >> (i * PAWN_BITS)) & PAWN_MASK);
+
+   return index;
+}
+
+
+static uint32_t next_config(uint32_t config, unsigned int nbPawns) {
+   assert(nbPawns <= MAX_NB_PAWNS);
+
+   // Odometer over the pawns, the last pawn being the least significant.
+   for(int i = nbPawns - 1; i >= 0; i--){
+      unsigned int shift = i * PAWN_BITS;
+      unsigned int pawn = ((config >> shift) & PAWN_MASK) + 1;
+
+      config &= ~((uint32_t) PAWN_MASK << shift);
+      if(pawn < NB_CONFIG_COLORS)
+         return config | (uint32_t) pawn << shift;
+   }
+
+   return config;
+}
+
+
+static bool is_consistent_config(ModelMastermind *mm, uint32_t config) {
+   assert(mm != NULL);
+
+   unsigned int nbPawns = mm->history.nbPawns;
+   unsigned int nbCorrect;
+   unsigned int nbMisplaced;
+
+   const History *history = &mm->history;
+
+   for(int i = history->nbCombinations - 1; i > history->currentIndex; i--){
+      determine_feedback_code(config, history->codes[i], nbPawns, &nbCorrect,
+                              &nbMisplaced);
+      if(nbCorrect != history->nbCorrect[i] ||
+         nbMisplaced != history->nbMisplaced[i])
+         return false;
+   }
+
+   return true;
+}
+
+
+static void filter_survivors(ModelMastermind *mm, uint32_t played,
+                             unsigned int nbCorrect, unsigned int nbMisplaced) {
+   assert(mm != NULL);
+
+   unsigned int nbPawns = mm->history.nbPawns;
+   unsigned int expectedKey = nbCorrect * (MAX_NB_PAWNS + 1) + nbMisplaced;
+   uint8_t keys[FEEDBACK_BLOCK];
+
+   if(mm->survivors == NULL){
+      unsigned int capacity = 1024;
+      mm->survivors = malloc(capacity * sizeof(uint32_t));
+      if(mm->survivors == NULL)
+         return;
+
+      uint32_t configs[FEEDBACK_BLOCK];
+      uint32_t config = decode_config(0, nbPawns);
+
+      mm->nbSurvivors = 0;
+      for(unsigned int i = 0; i < mm->nbConfigs; i += FEEDBACK_BLOCK){
+         unsigned int blockLength = mm->nbConfigs - i;
+         if(blockLength > FEEDBACK_BLOCK)
+            blockLength = FEEDBACK_BLOCK;
+
+         for(unsigned int k = 0; k < blockLength; k++){
+            configs[k] = config;
+            config = next_config(config, nbPawns);
+         }
+         determine_feedback_batch(played, configs, blockLength, nbPawns, keys);
+
+         for(unsigned int k = 0; k < blockLength; k++){
+            // Older rows only matter if a previous enumeration failed.
+            if(keys[k] != expectedKey || !is_consistent_config(mm, configs[k]))
+               continue;
+
+            if(mm->nbSurvivors == capacity){
+               capacity *= 2;
+               uint32_t *tmp = realloc(mm->survivors,
+                                       capacity * sizeof(uint32_t));
+               if(tmp == NULL){
+                  free(mm->survivors);
+                  mm->survivors = NULL;
+                  mm->nbSurvivors = 0;
+                  return;
+               }
+               mm->survivors = tmp;
+            }
+            mm->survivors[mm->nbSurvivors++] = configs[k];
+         }
+      }
+   } else{
+      unsigned int nbKept = 0;
+      for(unsigned int i = 0; i < mm->nbSurvivors; i += FEEDBACK_BLOCK){
+         unsigned int blockLength = mm->nbSurvivors - i;
+         if(blockLength > FEEDBACK_BLOCK)
+            blockLength = FEEDBACK_BLOCK;
+
+         determine_feedback_batch(played, mm->survivors + i, blockLength,
+                                  nbPawns, keys);
+
+         // Kept survivors never overtake the block being read.
+         for(unsigned int k = 0; k < blockLength; k++)
+            if(keys[k] == expectedKey)
+               mm->survivors[nbKept++] = mm->survivors[i + k];
+      }
+      mm->nbSurvivors = nbKept;
+   }
+}
+
+
+static bool find_first_consistent(ModelMastermind *mm, uint32_t *proposition) {
+   assert(mm != NULL && proposition != NULL);
+
+   unsigned int nbPawns = mm->history.nbPawns;
+
+   if(mm->survivors != NULL){
+      if(mm->nbSurvivors == 0)
+         return false;
+
+      *proposition = mm->survivors[0];
+      return true;
+   }
+
+   // No survivors yet: configurations are generated on the fly.
+   uint32_t config = decode_config(0, nbPawns);
+   for(unsigned int i = 0; i < mm->nbConfigs; i++){
+      if(is_consistent_config(mm, config)){
+         *proposition = config;
+         return true;
+      }
+      config = next_config(config, nbPawns);
+   }
+
+   return false;
+}
+
+
+static bool find_best_proposition(ModelMastermind *mm, uint32_t *proposition) {
+   assert(mm != NULL && proposition != NULL);
+
+   if(mm->useOpeningBook && find_book_proposition(mm, proposition))
+      return true;
+
+   unsigned int nbPawns = mm->history.nbPawns;
+   uint32_t openers[MAX_NB_OPENERS];
+   uint32_t *sample = NULL;
+
+   uint32_t *secretIndexes = NULL;
+
+   GuessSearch search;
+   search.solver = mm->solver;
+   search.nbPawns = nbPawns;
+   search.nbConfigs = mm->nbConfigs;
+   search.feedbackTable = NULL;
+   search.secretIndexes = NULL;
+
+   if(mm->survivors == NULL){
+      // Without survivors, only the first proposition can be searched.
+      if(mm->history.currentIndex != (int) mm->history.nbCombinations - 1)
+         return false;
+
+      search.candidates = openers;
+      search.nbCandidates = create_openers(nbPawns, openers);
+      search.secrets = NULL;
+      search.nbSecrets = mm->nbConfigs;
+   } else{
+      if(mm->nbSurvivors == 0)
+         return false;
+
+      if(mm->nbSurvivors <= 2){
+         *proposition = mm->survivors[0];
+         return true;
+      }
+
+      search.secrets = mm->survivors;
+      search.nbSecrets = mm->nbSurvivors;
+
+      if((unsigned long long) mm->nbConfigs * mm->nbSurvivors <=
+         mm->solverMaxWork){
+         search.candidates = NULL;
+         search.nbCandidates = mm->nbConfigs;
+      } else{
+         search.candidates = mm->survivors;
+         search.nbCandidates = mm->nbSurvivors;
+      }
+   }
+
+   if(nbPawns <= mm->feedbackTableMaxPawns &&
+      nbPawns <= MAX_FEEDBACK_TABLE_PAWNS){
+      search.feedbackTable = get_feedback_table(nbPawns);
+
+      if(search.feedbackTable != NULL && search.secrets != NULL){
+         secretIndexes = malloc(search.nbSecrets * sizeof(uint32_t));
+         if(secretIndexes == NULL)
+            search.feedbackTable = NULL;
+         else
+            for(unsigned int i = 0; i < search.nbSecrets; i++)
+               secretIndexes[i] = encode_config(search.secrets[i], nbPawns);
+         search.secretIndexes = secretIndexes;
+      }
+   }
+
+   // Samples the candidates evenly over the whole set to stay within the
+   // work budget, so that they do not all share the same first pawns.
+   unsigned long long maxCandidates = mm->solverMaxWork / search.nbSecrets;
+   if(maxCandidates == 0)
+      maxCandidates = 1;
+   if(search.nbCandidates > maxCandidates){
+      sample = malloc(maxCandidates * sizeof(uint32_t));
+      if(sample == NULL){
+         free(secretIndexes);
+         return false;
+      }
+
+      for(unsigned int i = 0; i < maxCandidates; i++){
+         unsigned int index = (unsigned long long) i * search.nbCandidates /
+                              maxCandidates;
+         sample[i] = (search.candidates != NULL) ? search.candidates[index]
+                                                 : decode_config(index,
+                                                                 nbPawns);
+      }
+
+      search.candidates = sample;
+      search.nbCandidates = maxCandidates;
+   }
+
+   GuessChoice best;
+   bool found = run_guess_search(&search, mm->nbSolverThreads, &best);
+
+   free(sample);
+   free(secretIndexes);
+
+   if(!found)
+      return false;
+
+   *proposition = best.proposition;
+   return true;
+}
+
+
+static bool find_book_proposition(ModelMastermind *mm, uint32_t *proposition) {
+   assert(mm != NULL && proposition != NULL);
+
+   const OpeningBook *book = &openingBooks[mm->solver];
+   unsigned int nbPawns = mm->history.nbPawns;
+   int firstIndex = mm->history.nbCombinations - 1;
+   uint32_t entry = 0;
+
+   if(mm->history.currentIndex == firstIndex)
+      entry = book->first[nbPawns];
+   else if(mm->history.currentIndex == firstIndex - 1 &&
+           (book->first[nbPawns] & BOOK_ENTRY_SET)){
+      const History *history = &mm->history;
+      if(history->codes[firstIndex] == (book->first[nbPawns] & ~BOOK_ENTRY_SET))
+         entry = book->second[nbPawns][history->nbCorrect[firstIndex] *
+                                       (MAX_NB_PAWNS + 1) +
+                                       history->nbMisplaced[firstIndex]];
+   }
+
+   if(!(entry & BOOK_ENTRY_SET))
+      return false;
+
+   *proposition = entry & ~BOOK_ENTRY_SET;
+   return true;
+}
+
+
+static bool
+parse_book_code(const char *pawns, unsigned int nbPawns, uint32_t *code) {
+   assert(pawns != NULL && code != NULL);
+
+   if(strlen(pawns) != nbPawns)
+      return false;
+
+   *code = 0;
+   for(unsigned int i = 0; i < nbPawns; i++){
+      if(pawns[i] < '0' || pawns[i] >= '0' + NB_CONFIG_COLORS)
+         return false;
+      *code |= (uint32_t) (pawns[i] - '0') << (i * PAWN_BITS);
+   }
+
+   return true;
+}
+
+
+static void format_book_code(uint32_t code, unsigned int nbPawns, char *pawns) {
+   assert(pawns != NULL && nbPawns <= MAX_NB_PAWNS);
+
+   for(unsigned int i = 0; i < nbPawns; i++)
+      pawns[i] = '0' + ((code >> (i * PAWN_BITS)) & PAWN_MASK);
+   pawns[nbPawns] = '\0';
+}
+
+
+static unsigned int create_openers(unsigned int nbPawns, uint32_t *openers) {
+   assert(openers != NULL && nbPawns <= MAX_NB_PAWNS);
+
+   unsigned int nbOpeners = 0;
+
+   for(unsigned int nbColors = NB_CONFIG_COLORS; nbColors > 0; nbColors--){
+      // parts[i] is the number of pawns of color i, in non-increasing order.
+      // Partitions are enumerated from {nbPawns} to {1, ..., 1}.
+      unsigned int parts[MAX_NB_PAWNS];
+      unsigned int nbParts = 1;
+      parts[0] = nbPawns;
+
+      while(nbParts > 0){
+         if(nbParts == nbColors && nbOpeners < MAX_NB_OPENERS){
+            uint32_t code = 0;
+            unsigned int pawn = 0;
+            for(unsigned int color = 0; color < nbParts; color++)
+               for(unsigned int j = 0; j < parts[color]; j++, pawn++)
+                  code |= (uint32_t) color << (pawn * PAWN_BITS);
+
+            openers[nbOpeners++] = code;
+         }
+
+         unsigned int remaining = 0;
+         while(nbParts > 0 && parts[nbParts - 1] == 1){
+            remaining++;
+            nbParts--;
+         }
+         if(nbParts == 0)
+            break;
+
+         parts[nbParts - 1]--;
+         remaining++;
+         while(remaining > parts[nbParts - 1]){
+            parts[nbParts] = parts[nbParts - 1];
+            remaining -= parts[nbParts];
+            nbParts++;
+         }
+         parts[nbParts++] = remaining;
+      }
+   }
+
+   return nbOpeners;
+}
+
+
+static void search_guess(const GuessSearch *search, unsigned int begin,
+                         unsigned int end, GuessChoice *best) {
+   assert(search != NULL && best != NULL && end <= search->nbCandidates);
+
+   unsigned int nbPawns = search->nbPawns;
+   unsigned int solvedKey = nbPawns * (MAX_NB_PAWNS + 1);
+   unsigned int partition[NB_FEEDBACK_KEYS];
+   uint8_t keys[FEEDBACK_BLOCK];
+   uint32_t secrets[FEEDBACK_BLOCK];
+
+   uint32_t candidate = 0;
+   if(search->candidates == NULL && begin < end)
+      candidate = decode_config(begin, nbPawns);
+
+   for(unsigned int i = begin; i < end; i++){
+      if(search->candidates != NULL)
+         candidate = search->candidates[i];
+      else if(i > begin)
+         candidate = next_config(candidate, nbPawns);
+
+      unsigned int worst = 0;
+      bool aborted = false;
+
+      const uint8_t *row = NULL;
+      if(search->feedbackTable != NULL){
+         unsigned int candidateIndex = (search->candidates != NULL)
+                                       ? encode_config(candidate, nbPawns) : i;
+         row = search->feedbackTable +
+               (size_t) candidateIndex * search->nbConfigs;
+      }
+
+      memset(partition, 0, sizeof(partition));
+
+      uint32_t secret = decode_config(0, nbPawns);
+      for(unsigned int j = 0; j < search->nbSecrets && !aborted;
+          j += FEEDBACK_BLOCK){
+         unsigned int blockLength = search->nbSecrets - j;
+         if(blockLength > FEEDBACK_BLOCK)
+            blockLength = FEEDBACK_BLOCK;
+
+         if(row != NULL){
+            for(unsigned int k = 0; k < blockLength; k++)
+               keys[k] = row[(search->secrets != NULL)
+                             ? search->secretIndexes[j + k] : j + k];
+         } else if(search->secrets != NULL)
+            determine_feedback_batch(candidate, search->secrets + j,
+                                     blockLength, nbPawns, keys);
+         else{
+            for(unsigned int k = 0; k < blockLength; k++){
+               secrets[k] = secret;
+               secret = next_config(secret, nbPawns);
+            }
+            determine_feedback_batch(candidate, secrets, blockLength, nbPawns,
+                                     keys);
+         }
+
+         for(unsigned int k = 0; k < blockLength && !aborted; k++){
+            if(++partition[keys[k]] > worst){
+               worst = partition[keys[k]];
+               // Minimax can not get better than the best one any more.
+               aborted = search->solver == SOLVER_MINIMAX && best->found &&
+                         worst > best->score;
+            }
+         }
+      }
+
+      if(aborted)
+         continue;
+
+      GuessChoice choice;
+      choice.found = true;
+      choice.proposition = candidate;
+      choice.index = i;
+      choice.score = score_partition(search->solver, partition, worst);
+      choice.isSecret = partition[solvedKey] > 0;
+
+      if(is_better_choice(&choice, best))
+         *best = choice;
+   }
+}
+
+
+static bool run_guess_search(const GuessSearch *search, unsigned int nbThreads,
+                             GuessChoice *best) {
+   assert(search != NULL && best != NULL && nbThreads > 0);
+
+   unsigned long long work = (unsigned long long) search->nbCandidates *
+                             search->nbSecrets;
+   if(work < SOLVER_MIN_THREADED_WORK)
+      nbThreads = 1;
+   if(nbThreads > search->nbCandidates)
+      nbThreads = search->nbCandidates;
+
+   best->found = false;
+
+   if(nbThreads <= 1){
+      search_guess(search, 0, search->nbCandidates, best);
+      return best->found;
+   }
+
+   GuessWorker *workers = malloc(nbThreads * sizeof(GuessWorker));
+   pthread_t *threads = malloc(nbThreads * sizeof(pthread_t));
+   if(workers == NULL || threads == NULL){
+      free(workers);
+      free(threads);
+      search_guess(search, 0, search->nbCandidates, best);
+      return best->found;
+   }
+
+   pthread_mutex_t lock;
+   pthread_mutex_init(&lock, NULL);
+   unsigned int nextCandidate = 0;
+   unsigned int chunkSize = search->nbCandidates /
+                            (nbThreads * SOLVER_CHUNKS_PER_THREAD);
+   if(chunkSize == 0)
+      chunkSize = 1;
+
+   // Worker 0 runs in the calling thread.
+   unsigned int nbStarted = 1;
+   for(unsigned int i = 0; i < nbThreads; i++){
+      workers[i].search = search;
+      workers[i].lock = &lock;
+      workers[i].nextCandidate = &nextCandidate;
+      workers[i].chunkSize = chunkSize;
+      workers[i].best.found = false;
+
+      if(i > 0 && pthread_create(&threads[i], NULL, run_guess_worker,
+                                 &workers[i]) == 0)
+         nbStarted++;
+   }
+
+   run_guess_worker(&workers[0]);
+
+   for(unsigned int i = 1; i < nbStarted; i++)
+      pthread_join(threads[i], NULL);
+
+   for(unsigned int i = 0; i < nbStarted; i++)
+      if(is_better_choice(&workers[i].best, best))
+         *best = workers[i].best;
+
+   pthread_mutex_destroy(&lock);
+   free(threads);
+   free(workers);
+
+   return best->found;
+}
+
+
+static void *run_guess_worker(void *data) {
+   assert(data != NULL);
+
+   GuessWorker *worker = (GuessWorker *) data;
+   unsigned int nbCandidates = worker->search->nbCandidates;
+
+   while(true){
+      pthread_mutex_lock(worker->lock);
+      unsigned int begin = *worker->nextCandidate;
+      if(begin < nbCandidates)
+         *worker->nextCandidate += (nbCandidates - begin < worker->chunkSize)
+                                   ? nbCandidates - begin : worker->chunkSize;
+      unsigned int end = *worker->nextCandidate;
+      pthread_mutex_unlock(worker->lock);
+
+      if(begin >= nbCandidates)
+         break;
+
+      search_guess(worker->search, begin, end, &worker->best);
+   }
+
+   return NULL;
+}
+
+
+static bool is_better_choice(const GuessChoice *choice, const GuessChoice *best) {
+   assert(choice != NULL && best != NULL);
+
+   if(!choice->found)
+      return false;
+   if(!best->found || choice->score != best->score)
+      return !best->found || choice->score < best->score;
+   if(choice->isSecret != best->isSecret)
+      return choice->isSecret;
+
+   return choice->index < best->index;
+}
+
+
+static double
+score_partition(SOLVER solver, const unsigned int *partition, unsigned int worst) {
+   assert(partition != NULL);
+
+   unsigned int total = 0;
+   double sum = 0;
+
+   switch(solver){
+      case SOLVER_ENTROPY:
+         // Entropy is maximised: sum(p * log2(p)) = -entropy is minimised.
+         for(unsigned int i = 0; i < NB_FEEDBACK_KEYS; i++)
+            total += partition[i];
+         for(unsigned int i = 0; i < NB_FEEDBACK_KEYS; i++)
+            if(partition[i] > 0)
+               sum += (double) partition[i] / total *
+                      log2((double) partition[i] / total);
+         return sum;
+
+      case SOLVER_EXPECTED_SIZE:
+         // Expected size of the part is sum(n_i^2) / total, total is constant.
+         for(unsigned int i = 0; i < NB_FEEDBACK_KEYS; i++)
+            sum += (double) partition[i] * partition[i];
+         return sum;
+
+      case SOLVER_MINIMAX:
+      default:
+         return worst;
+   }
+}
+
+
+static void
+determine_feedback_batch(uint32_t proposition, const uint32_t *solutions,
+                         unsigned int nbSolutions, unsigned int nbPawns,
+                         uint8_t *keys) {
+   assert(solutions != NULL && keys != NULL);
+
+#ifdef FEEDBACK_SIMD
+   if(is_feedback_kernel_supported(FEEDBACK_KERNEL_AVX2))
+      determine_feedback_batch_avx2(proposition, solutions, nbSolutions,
+                                    nbPawns, keys);
+   else
+#endif
+      determine_feedback_batch_scalar(proposition, solutions, nbSolutions,
+                                      nbPawns, keys);
+}
+
+
+static void
+determine_feedback_batch_scalar(uint32_t proposition, const uint32_t *solutions,
+                                unsigned int nbSolutions, unsigned int nbPawns,
+                                uint8_t *keys) {
+   uint64_t propositionColors = count_colors(proposition, nbPawns);
+
+   for(unsigned int i = 0; i < nbSolutions; i++)
+      keys[i] = get_feedback_key(proposition, propositionColors, solutions[i],
+                                 count_colors(solutions[i], nbPawns), nbPawns);
+}
+
+
+#ifdef FEEDBACK_SIMD
+static uint64_t expand_code(uint32_t code, unsigned int nbPawns, uint8_t padding) {
+   uint64_t expanded = 0;
+
+   for(unsigned int i = 0; i < MAX_NB_PAWNS; i++){
+      uint64_t pawn = (i < nbPawns) ? (code >> (i * PAWN_BITS)) & PAWN_MASK
+                                    : padding;
+      expanded |= pawn << (i * 8);
+   }
+
+   return expanded;
+}
+
+
+/*
+ * The kernel works on pawns expanded to bytes, by pdep for the solutions.
+ * Padding bytes differ between the proposition and the solutions and are not
+ * colors, so they never match. For each 64 bits lane (one solution):
+ *    nbCorrect = sum of the bytes of (solution == proposition) & 1
+ *    nbCommon = sum over colors of min(count in solution, count in proposition)
+ *    key = nbCorrect * (MAX_NB_PAWNS + 1) + nbCommon - nbCorrect
+ */
+__attribute__((target("avx2,bmi2")))
+static void
+determine_feedback_batch_avx2(uint32_t proposition, const uint32_t *solutions,
+                              unsigned int nbSolutions, unsigned int nbPawns,
+                              uint8_t *keys) {
+   const __m256i ones = _mm256_set1_epi8(1);
+   const __m256i zero = _mm256_setzero_si256();
+   const __m256i expandedProposition = _mm256_set1_epi64x(
+           expand_code(proposition, nbPawns, 0x40));
+   const uint64_t PAWN_BYTES = 0x0707070707070707ULL;
+   const uint64_t padding = expand_code(0, nbPawns, 0x80);
+
+   uint64_t propositionColors = count_colors(proposition, nbPawns);
+   __m256i nbColorsInProposition[NB_CONFIG_COLORS];
+   for(unsigned int c = 0; c < NB_CONFIG_COLORS; c++)
+      nbColorsInProposition[c] = _mm256_set1_epi64x(
+              (propositionColors >> (c * 8)) & 0xFF);
+
+   unsigned int i = 0;
+   for(; i + 4 <= nbSolutions; i += 4){
+      __m256i solution = _mm256_set_epi64x(
+              _pdep_u64(solutions[i + 3], PAWN_BYTES) | padding,
+              _pdep_u64(solutions[i + 2], PAWN_BYTES) | padding,
+              _pdep_u64(solutions[i + 1], PAWN_BYTES) | padding,
+              _pdep_u64(solutions[i], PAWN_BYTES) | padding);
+
+      __m256i nbCorrect = _mm256_sad_epu8(
+              _mm256_and_si256(_mm256_cmpeq_epi8(solution, expandedProposition),
+                               ones), zero);
+
+      __m256i nbCommon = zero;
+      for(unsigned int c = 0; c < NB_CONFIG_COLORS; c++){
+         __m256i nbColor = _mm256_sad_epu8(
+                 _mm256_and_si256(_mm256_cmpeq_epi8(solution,
+                                                    _mm256_set1_epi8(c)), ones),
+                 zero);
+         nbCommon = _mm256_add_epi64(nbCommon, _mm256_min_epu32(
+                 nbColor, nbColorsInProposition[c]));
+      }
+
+      __m256i key = _mm256_add_epi64(nbCommon, _mm256_slli_epi64(nbCorrect, 3));
+      keys[i] = _mm256_extract_epi32(key, 0);
+      keys[i + 1] = _mm256_extract_epi32(key, 2);
+      keys[i + 2] = _mm256_extract_epi32(key, 4);
+      keys[i + 3] = _mm256_extract_epi32(key, 6);
+   }
+
+   determine_feedback_batch_scalar(proposition, solutions + i, nbSolutions - i,
+                                   nbPawns, keys + i);
+}
+#endif
+
+
+static const uint8_t *get_feedback_table(unsigned int nbPawns) {
+   assert(nbPawns <= MAX_FEEDBACK_TABLE_PAWNS);
+
+   pthread_mutex_lock(&feedbackTablesLock);
+
+   if(feedbackTables[nbPawns] == NULL){
+      unsigned int nbConfigs = pow(NB_CONFIG_COLORS, nbPawns);
+      uint8_t *table = malloc(get_feedback_table_size(nbPawns));
+
+      if(table != NULL){
+         uint32_t proposition = decode_config(0, nbPawns);
+         for(unsigned int i = 0; i < nbConfigs; i++){
+            uint64_t propositionColors = count_colors(proposition, nbPawns);
+            uint8_t *row = table + (size_t) i * nbConfigs;
+
+            uint32_t solution = decode_config(0, nbPawns);
+            for(unsigned int j = 0; j < nbConfigs; j++){
+               row[j] = get_feedback_key(proposition, propositionColors,
+                                         solution,
+                                         count_colors(solution, nbPawns),
+                                         nbPawns);
+               solution = next_config(solution, nbPawns);
+            }
+
+            proposition = next_config(proposition, nbPawns);
+         }
+      }
+
+      feedbackTables[nbPawns] = table;
+   }
+
+   pthread_mutex_unlock(&feedbackTablesLock);
+
+   return feedbackTables[nbPawns];
+}
+
+
+static uint64_t count_colors(uint32_t code, unsigned int nbPawns) {
+   uint64_t colors = 0;
+
+   for(unsigned int i = 0; i < nbPawns; i++){
+      colors += (uint64_t) 1 << ((code & PAWN_MASK) * 8);
+      code >>= PAWN_BITS;
+   }
+
+   return colors;
+}
+
+
+static unsigned int
+get_feedback_key(uint32_t proposition, uint64_t propositionColors,
+                 uint32_t solution, uint64_t solutionColors,
+                 unsigned int nbPawns) {
+   const uint32_t FIRST_BITS = 011111111;   // Lowest bit of each pawn.
+   const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+   const uint64_t LOW_BITS = 0x0101010101010101ULL;
+
+   // A pawn is correct if its PAWN_BITS bits are equal.
+   uint32_t diff = proposition ^ solution;
+   diff = (diff | diff >> 1 | diff >> 2) & FIRST_BITS &
+          (((uint32_t) 1 << (nbPawns * PAWN_BITS)) - 1);
+   unsigned int nbDiff = 0;
+   for(; diff != 0; diff &= diff - 1)
+      nbDiff++;
+   unsigned int nbCorrect = nbPawns - nbDiff;
+
+   // Common pawns: byte-wise minimum of the color counts (all <= 8), summed.
+   uint64_t greaterOrEqual = (((propositionColors | HIGH_BITS) -
+                               solutionColors) & HIGH_BITS) >> 7;
+   greaterOrEqual *= 0xFF;
+   uint64_t minimum = (solutionColors & greaterOrEqual) |
+                      (propositionColors & ~greaterOrEqual);
+   unsigned int nbCommon = (minimum * LOW_BITS) >> 56;
+
+   return nbCorrect * (MAX_NB_PAWNS + 1) + (nbCommon - nbCorrect);
+}
+
+
+static uint32_t pack_pawns(const uint8_t *pawns, unsigned int nbPawns) {
+   assert(pawns != NULL && nbPawns <= MAX_NB_PAWNS);
+
+   uint32_t code = 0;
+   for(unsigned int i = 0; i < nbPawns; i++)
+      code |= (uint32_t) pawns[i] << (i * PAWN_BITS);
+
+   return code;
+}
+
+
+static uint32_t pack_solution(const PAWN_COLOR *solution, unsigned int nbPawns) {
+   assert(solution != NULL && nbPawns <= MAX_NB_PAWNS);
+
+   uint32_t code = 0;
+   for(unsigned int i = 0; i < nbPawns; i++)
+      code |= (uint32_t) solution[i] << (i * PAWN_BITS);
+
+   return code;
+}
+
+
+static void unpack_code(uint32_t code, unsigned int nbPawns, uint8_t *pawns) {
+   assert(pawns != NULL);
+
+   for(unsigned int i = 0; i < nbPawns; i++)
+      pawns[i] = (code >> (i * PAWN_BITS)) & PAWN_MASK;
+}
+
+
+static void determine_feedback_code(uint32_t proposition, uint32_t solution,
+                                    unsigned int nbPawns,
+                                    unsigned int *nbCorrect,
+                                    unsigned int *nbMisplaced) {
+   assert(nbCorrect != NULL && nbMisplaced != NULL);
+
+   unsigned int key = get_feedback_key(proposition,
+                                       count_colors(proposition, nbPawns),
+                                       solution, count_colors(solution, nbPawns),
+                                       nbPawns);
+
+   *nbCorrect = key / (MAX_NB_PAWNS + 1);
+   *nbMisplaced = key % (MAX_NB_PAWNS + 1);
+}
+
+
+static void update_score(ModelMastermind *mm) {
+   assert(mm != NULL);
+
+   if(mm->save == NULL)
+      return;
+
+   if(record_score(mm->save, mm->savedPseudo, 1) != 0)
+      fprintf(stderr, "Error while recording a score\n");
+}
+
+
+ModelMainMenu *create_model_main_menu(void) {
+   ModelMainMenu *mmm = malloc(sizeof(ModelMainMenu));
+   if(mmm == NULL)
+      return NULL;
+
+   strcpy(mmm->pseudo, DEFAULT_PSEUDO);
+   mmm->validPseudo = false;
+   mmm->role = GUESSER;
+   mmm->nbPawns = DEFAULT_NB_PAWNS;
+   mmm->solver = DEFAULT_SOLVER;
+   mmm->nbSolverThreads = DEFAULT_SOLVER_THREADS;
+   mmm->feedbackTableMaxPawns = DEFAULT_FEEDBACK_TABLE_PAWNS;
+   mmm->seed = time(NULL);
+   mmm->scores = NULL;
+   mmm->saveScores = true;
+
+   return mmm;
+}
+
+
+void destroy_model_main_menu(ModelMainMenu *mmm) {
+   if(mmm != NULL){
+      if(mmm->scores != NULL)
+         destroy_saved_scores(mmm->scores);
+      free(mmm);
+   }
+}
+
+
+ModelMastermind *create_model_mastermind(ModelMainMenu *mmm) {
+   ModelMastermind *mm = malloc(sizeof(ModelMastermind));
+   if(mm == NULL)
+      return NULL;
+
+   init_history(&mm->history, mmm->nbPawns);
+   reset_proposition(mm);
+   reset_feedback(mm);
+   for(unsigned int i = 0; i < mmm->nbPawns; i++)
+      mm->solution[i] = PAWN_DEFAULT;
+
+   // Copy main menu settings in game model.
+   mm->role = mmm->role;
+   strcpy(mm->savedPseudo, mmm->pseudo);
+   mm->inGame = true;
+   mm->selectedColor = PAWN_BLUE;
+   mm->validSolution = false;
+   mm->nbConfigs = pow(NB_CONFIG_COLORS, mm->history.nbPawns);
+   mm->survivors = NULL;
+   mm->nbSurvivors = 0;
+   mm->solver = mmm->solver;
+   mm->nbSolverThreads = mmm->nbSolverThreads;
+   mm->feedbackTableMaxPawns = mmm->feedbackTableMaxPawns;
+   mm->solverMaxWork = SOLVER_MAX_WORK;
+   mm->useOpeningBook = true;
+   // Every game draws a new solution.
+   mm->randomState = mix_seed(mmm->seed++);
+   if(mm->nbSolverThreads == 0){
+      long nbProcessors = sysconf(_SC_NPROCESSORS_ONLN);
+      mm->nbSolverThreads = (nbProcessors > 0) ? nbProcessors : 1;
+   }
+
+   // The scores are loaded once, and kept for the next games.
+   mm->save = NULL;
+   if(mmm->saveScores){
+      if(mmm->scores == NULL)
+         mmm->scores = load_scores(SAVED_SCORES_PATH, LEGACY_SCORES_PATH);
+      mm->save = mmm->scores;
+      if(mm->save == NULL){
+         free(mm);
+         return NULL;
+      }
+   }
+
+   return mm;
+}
+
+
+void destroy_model_mastermind(ModelMastermind *mm) {
+   if(mm != NULL){
+      free(mm->survivors);
+      free(mm);
+   }
+}
+
+static char *create_path(const char *path, const char *suffix) {
+   assert(path != NULL && suffix != NULL);
+
+   char *newPath = malloc(strlen(path) + strlen(suffix) + 1);
+   if(newPath == NULL)
+      return NULL;
+
+   strcpy(newPath, path);
+   strcat(newPath, suffix);
+
+   return newPath;
+}
+
+
+static int grow_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   uint32_t capacity = scores->header->capacity * 2;
+   size_t size = sizeof(ScoresHeader) + (size_t) capacity * sizeof(Score);
+
+   void *memory = malloc(size);
+   if(memory == NULL)
+      return -1;
+
+   memcpy(memory, scores->memory, sizeof(ScoresHeader) +
+          (size_t) scores->header->length * sizeof(Score));
+
+   if(scores->mapped)
+      munmap(scores->memory, scores->memorySize);
+   else
+      free(scores->memory);
+
+   scores->memory = memory;
+   scores->memorySize = size;
+   scores->mapped = false;
+   scores->header = memory;
+   scores->records = (Score *) (scores->header + 1);
+   scores->header->capacity = capacity;
+
+   return 0;
+}
+
+
+static uint32_t checksum_journal_record(const JournalRecord *record) {
+   assert(record != NULL);
+
+   // Copied byte by byte to keep the padding.
+   JournalRecord copy;
+   memcpy(&copy, record, sizeof(copy));
+   copy.checksum = 0;
+
+   const unsigned char *bytes = (const unsigned char *) &copy;
+   uint32_t hash = 2166136261u;
+   for(size_t i = 0; i < sizeof(copy); i++){
+      hash ^= bytes[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+
+static int lock_scores_file(SavedScores *scores) {
+   assert(scores != NULL);
+
+   struct flock lock;
+   memset(&lock, 0, sizeof(lock));
+   lock.l_type = F_WRLCK;
+   lock.l_whence = SEEK_SET;
+
+   pthread_mutex_lock(&scoresFilesLock);
+
+   int status;
+   do
+      status = fcntl(scores->lockFd, F_SETLKW, &lock);
+   while(status != 0 && errno == EINTR);
+
+   if(status != 0){
+      pthread_mutex_unlock(&scoresFilesLock);
+      return -1;
+   }
+
+   return 0;
+}
+
+
+static void unlock_scores_file(SavedScores *scores) {
+   assert(scores != NULL);
+
+   struct flock lock;
+   memset(&lock, 0, sizeof(lock));
+   lock.l_type = F_UNLCK;
+   lock.l_whence = SEEK_SET;
+
+   fcntl(scores->lockFd, F_SETLK, &lock);
+   pthread_mutex_unlock(&scoresFilesLock);
+}
+
+
+static void set_scores_memory(SavedScores *scores, void *memory,
+                              size_t memorySize, bool mapped) {
+   assert(scores != NULL && memory != NULL);
+
+   if(scores->mapped)
+      munmap(scores->memory, scores->memorySize);
+   else
+      free(scores->memory);
+
+   scores->memory = memory;
+   scores->memorySize = memorySize;
+   scores->mapped = mapped;
+   scores->header = memory;
+   scores->records = (Score *) (scores->header + 1);
+
+   // The index is built again for the new records.
+   free(scores->index);
+   scores->index = NULL;
+   scores->indexCapacity = 0;
+   scores->nbIndexed = 0;
+   scores->nbChanges++;
+}
+
+
+static int create_empty_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   size_t memorySize = sizeof(ScoresHeader) +
+                       SCORES_FILE_MIN_CAPACITY * sizeof(Score);
+   void *memory = calloc(1, memorySize);
+   if(memory == NULL)
+      return -1;
+
+   ScoresHeader *header = memory;
+   header->magic = SCORES_FILE_MAGIC;
+   header->version = SCORES_FILE_VERSION;
+   header->recordSize = sizeof(Score);
+   header->capacity = SCORES_FILE_MIN_CAPACITY;
+
+   set_scores_memory(scores, memory, memorySize, false);
+
+   return 0;
+}
+
+
+static int map_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   int fd = open(scores->filePath, O_RDONLY);
+   if(fd < 0){
+      if(errno != ENOENT)
+         return -1;
+
+      // Without score file, the scores start empty at generation 0.
+      return create_empty_scores(scores);
+   }
+
+   ScoresHeader header;
+   struct stat status;
+
+   if(fstat(fd, &status) != 0){
+      close(fd);
+      return -1;
+   }
+
+   if((size_t) status.st_size < sizeof(header) ||
+      pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      header.magic != SCORES_FILE_MAGIC ||
+      header.version != SCORES_FILE_VERSION ||
+      header.recordSize != sizeof(Score) ||
+      header.length > header.capacity ||
+      header.nbTop > MAX_SCORE_DISPLAYED ||
+      header.nbTop > header.length ||
+      (size_t) status.st_size <
+      sizeof(header) + (size_t) header.capacity * sizeof(Score)){
+      close(fd);
+      return 1;
+   }
+
+   // Changes stay private, they are saved in the journal.
+   size_t memorySize = sizeof(header) + (size_t) header.capacity * sizeof(Score);
+   void *memory = mmap(NULL, memorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+   close(fd);
+   if(memory == MAP_FAILED)
+      return -1;
+
+   set_scores_memory(scores, memory, memorySize, true);
+
+   return 0;
+}
+
+
+static int upgrade_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   int fd = open(scores->filePath, O_RDONLY);
+   if(fd < 0)
+      return -1;
+
+   ScoresHeaderV1 header;
+   struct stat status;
+
+   if(fstat(fd, &status) != 0){
+      close(fd);
+      return -1;
+   }
+
+   // The headers of every version start with the fields of version 1.
+   size_t headerSize = 0;
+   if((size_t) status.st_size >= sizeof(header) &&
+      pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+      header.magic == SCORES_FILE_MAGIC &&
+      header.recordSize == sizeof(Score) &&
+      header.length <= header.capacity){
+      if(header.version == 1)
+         headerSize = sizeof(ScoresHeaderV1);
+      else if(header.version == 2)
+         headerSize = sizeof(ScoresHeaderV2);
+   }
+
+   if(headerSize == 0 || (size_t) status.st_size <
+      headerSize + (size_t) header.length * sizeof(Score)){
+      close(fd);
+      return 1;
+   }
+
+   size_t size = (size_t) header.length * sizeof(Score);
+   Score *records = (size > 0) ? malloc(size) : NULL;
+   if(size > 0 && records == NULL){
+      close(fd);
+      return -1;
+   }
+
+   ssize_t nbRead = pread(fd, records, size, headerSize);
+   close(fd);
+   if(nbRead < 0 || (size_t) nbRead != size){
+      free(records);
+      return -1;
+   }
+
+   // The records are added again to build the index and the top scores.
+   int upgraded = create_empty_scores(scores);
+   for(uint32_t i = 0; i < header.length && upgraded == 0; i++){
+      records[i].pseudo[MAX_PSEUDO_LENGTH] = '\0';
+      upgraded = apply_score(scores, records[i].pseudo, records[i].score);
+   }
+   free(records);
+
+   if(upgraded != 0)
+      return -1;
+
+   return compact_scores(scores, scores->header);
+}
+
+
+static int recover_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   int status = upgrade_scores(scores);
+   if(status != 1)
+      return status;
+
+   char *invalidPath = create_path(scores->filePath, SCORES_INVALID_SUFFIX);
+   if(invalidPath == NULL)
+      return -1;
+
+   if(rename(scores->filePath, invalidPath) != 0){
+      free(invalidPath);
+      return -1;
+   }
+   fprintf(stderr, "Invalid score file %s moved to %s, the scores start "
+           "empty\n", scores->filePath, invalidPath);
+   free(invalidPath);
+
+   return create_empty_scores(scores);
+}
+
+
+static int import_text_scores(SavedScores *scores, const char *textPath) {
+   assert(scores != NULL && textPath != NULL && scores->header->length == 0);
+
+   FILE *pFile = fopen(textPath, "r");
+   if(pFile == NULL)
+      return (errno == ENOENT) ? 0 : -1;
+
+   char format[16];
+   snprintf(format, sizeof(format), "%%%us %%u", MAX_PSEUDO_LENGTH);
+
+   char pseudo[MAX_PSEUDO_LENGTH + 1];
+   unsigned length, score;
+   unsigned i = 0;
+   int status = 0;
+
+   if(fscanf(pFile, "%u", &length) != 1)
+      length = 0;
+
+   for(; i < length && status == 0; i++){
+      if(fscanf(pFile, format, pseudo, &score) != 2)
+         break;
+      status = apply_score(scores, pseudo, score);
+   }
+   fclose(pFile);
+
+   if(status == 0 && i < length)
+      fprintf(stderr, "Invalid score file %s, %u scores imported\n",
+              textPath, i);
+
+   // Without scores, the text file is read again by the next load.
+   if(status != 0 || scores->header->length == 0)
+      return status;
+
+   return compact_scores(scores, scores->header);
+}
+
+
+static int read_journal(SavedScores *scores, JournalRecord **records,
+                        uint32_t *nbRecords) {
+   assert(scores != NULL && records != NULL && nbRecords != NULL &&
+          scores->journal != NULL);
+
+   FILE *pFile = scores->journal;
+   uint32_t capacity = 0;
+   JournalRecord record;
+
+   *records = NULL;
+   *nbRecords = 0;
+
+   if(fseek(pFile, scores->journalOffset, SEEK_SET) != 0)
+      return -1;
+
+   while(fread(&record, sizeof(record), 1, pFile) == 1 &&
+         record.checksum == checksum_journal_record(&record)){
+      if(*nbRecords == capacity){
+         capacity = (capacity > 0) ? capacity * 2 : 16;
+         JournalRecord *newRecords = realloc(*records,
+                                             capacity * sizeof(JournalRecord));
+         if(newRecords == NULL){
+            free(*records);
+            *records = NULL;
+            return -1;
+         }
+         *records = newRecords;
+      }
+
+      record.pseudo[MAX_PSEUDO_LENGTH] = '\0';
+      (*records)[(*nbRecords)++] = record;
+      scores->journalOffset += sizeof(record);
+   }
+   scores->nbJournalRecords += *nbRecords;
+
+   // Drops a record torn by a crash, so that the next ones can be read.
+   if(fflush(pFile) != 0 || ftruncate(fileno(pFile),
+                                      scores->journalOffset) != 0){
+      free(*records);
+      *records = NULL;
+      return -1;
+   }
+
+   return 0;
+}
+
+
+static int replay_journal(SavedScores *scores) {
+   assert(scores != NULL);
+
+   if(scores->journal != NULL){
+      fclose(scores->journal);
+      scores->journal = NULL;
+   }
+   scores->nbJournalRecords = 0;
+
+   FILE *pFile = fopen(scores->journalPath, "r+b");
+   JournalHeader header;
+
+   if(pFile == NULL || fread(&header, sizeof(header), 1, pFile) != 1 ||
+      header.magic != SCORES_JOURNAL_MAGIC ||
+      header.version != SCORES_JOURNAL_VERSION ||
+      header.recordSize != sizeof(JournalRecord) ||
+      header.generation != scores->header->generation){
+      // No journal, or one already compacted in the score file.
+      if(pFile != NULL)
+         fclose(pFile);
+      return reset_journal(scores, scores->header->generation);
+   }
+
+   scores->journal = pFile;
+   scores->journalOffset = sizeof(header);
+
+   JournalRecord *records;
+   uint32_t nbRecords;
+   if(read_journal(scores, &records, &nbRecords) != 0)
+      return -1;
+
+   int status = 0;
+   for(uint32_t i = 0; i < nbRecords && status == 0; i++)
+      status = apply_score(scores, records[i].pseudo, records[i].delta);
+
+   free(records);
+   return status;
+}
+
+
+static int sync_journal(SavedScores *scores) {
+   assert(scores != NULL);
+
+   struct stat current, opened;
+   int status = 0;
+
+   if(scores->journal != NULL && stat(scores->journalPath, &current) == 0 &&
+      fstat(fileno(scores->journal), &opened) == 0 &&
+      current.st_dev == opened.st_dev && current.st_ino == opened.st_ino){
+      JournalRecord *records;
+      uint32_t nbRecords;
+      if(read_journal(scores, &records, &nbRecords) != 0)
+         return -1;
+
+      pthread_mutex_lock(&scores->lock);
+      for(uint32_t i = 0; i < nbRecords && status == 0; i++)
+         status = apply_score(scores, records[i].pseudo, records[i].delta);
+      pthread_mutex_unlock(&scores->lock);
+
+      free(records);
+      return status;
+   }
+
+   // Another process replaced the journal while compacting it, the new score
+   // file holds what this one had read.
+   pthread_mutex_lock(&scores->lock);
+
+   if(map_scores(scores) != 0 || replay_journal(scores) != 0)
+      status = -1;
+
+   // The pending changes are not in the files yet.
+   for(uint32_t i = 0; i < scores->nbPending && status == 0; i++)
+      status = apply_score(scores, scores->pending[i].pseudo,
+                           scores->pending[i].delta);
+
+   pthread_mutex_unlock(&scores->lock);
+
+   return status;
+}
+
+
+static int reset_journal(SavedScores *scores, uint32_t generation) {
+   assert(scores != NULL);
+
+   if(scores->journal != NULL){
+      fclose(scores->journal);
+      scores->journal = NULL;
+   }
+   scores->nbJournalRecords = 0;
+
+   char *temporaryPath = create_path(scores->journalPath,
+                                     SCORES_TEMPORARY_SUFFIX);
+   if(temporaryPath == NULL)
+      return -1;
+
+   JournalHeader header;
+   header.magic = SCORES_JOURNAL_MAGIC;
+   header.version = SCORES_JOURNAL_VERSION;
+   header.recordSize = sizeof(JournalRecord);
+   header.generation = generation;
+
+   FILE *pFile = fopen(temporaryPath, "wb");
+   if(pFile == NULL){
+      free(temporaryPath);
+      return -1;
+   }
+
+   bool written = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+                  fflush(pFile) == 0 && fsync(fileno(pFile)) == 0;
+   if(fclose(pFile) != 0 || !written ||
+      rename(temporaryPath, scores->journalPath) != 0){
+      remove(temporaryPath);
+      free(temporaryPath);
+      return -1;
+   }
+   free(temporaryPath);
+
+   scores->journal = fopen(scores->journalPath, "r+b");
+   if(scores->journal == NULL)
+      return -1;
+   scores->journalOffset = sizeof(header);
+
+   return 0;
+}
+
+
+static int compact_scores(SavedScores *scores, const ScoresHeader *snapshot) {
+   assert(scores != NULL && snapshot != NULL);
+
+   char *temporaryPath = create_path(scores->filePath, SCORES_TEMPORARY_SUFFIX);
+   if(temporaryPath == NULL)
+      return -1;
+
+   FILE *pFile = fopen(temporaryPath, "wb");
+   if(pFile == NULL){
+      free(temporaryPath);
+      return -1;
+   }
+
+   ScoresHeader header = *snapshot;
+   header.generation++;
+
+   // The free records are left as a hole of the file.
+   bool written = fwrite(&header, sizeof(header), 1, pFile) == 1 &&
+                  fwrite(snapshot + 1, sizeof(Score), header.length,
+                         pFile) == header.length &&
+                  fflush(pFile) == 0 &&
+                  ftruncate(fileno(pFile), sizeof(header) +
+                            (size_t) header.capacity * sizeof(Score)) == 0 &&
+                  fsync(fileno(pFile)) == 0;
+   if(fclose(pFile) != 0 || !written ||
+      rename(temporaryPath, scores->filePath) != 0){
+      remove(temporaryPath);
+      free(temporaryPath);
+      return -1;
+   }
+   free(temporaryPath);
+
+   pthread_mutex_lock(&scores->lock);
+   scores->header->generation = header.generation;
+   pthread_mutex_unlock(&scores->lock);
+
+   return reset_journal(scores, header.generation);
+}
+
+
+static int flush_pending_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   pthread_mutex_lock(&scores->lock);
+   bool empty = scores->nbPending == 0;
+   pthread_mutex_unlock(&scores->lock);
+
+   if(empty)
+      return 0;
+
+   // The pending changes are kept for the next flush.
+   if(lock_scores_file(scores) != 0)
+      return -1;
+   if(sync_journal(scores) != 0){
+      unlock_scores_file(scores);
+      return -1;
+   }
+
+   pthread_mutex_lock(&scores->lock);
+
+   JournalRecord *batch = scores->pending;
+   uint32_t batchCapacity = scores->pendingCapacity;
+   uint32_t nbRecords = scores->nbPending;
+   scores->pending = scores->batch;
+   scores->pendingCapacity = scores->batchCapacity;
+   scores->nbPending = 0;
+   scores->batch = batch;
+   scores->batchCapacity = batchCapacity;
+
+   // The snapshot already holds the changes of the batch.
+   ScoresHeader *snapshot = NULL;
+   if(nbRecords > 0 &&
+      scores->nbJournalRecords + nbRecords >= SCORES_JOURNAL_MAX_RECORDS){
+      size_t size = sizeof(ScoresHeader) +
+                    (size_t) scores->header->length * sizeof(Score);
+      snapshot = malloc(size);
+      if(snapshot != NULL)
+         memcpy(snapshot, scores->header, size);
+   }
+
+   pthread_mutex_unlock(&scores->lock);
+
+   int status = -1;
+   if(snapshot != NULL){
+      status = compact_scores(scores, snapshot);
+      free(snapshot);
+   }
+
+   // Without compaction, the changes are kept in the journal.
+   if(status != 0 && scores->journal != NULL){
+      for(uint32_t i = 0; i < nbRecords; i++)
+         batch[i].checksum = checksum_journal_record(&batch[i]);
+
+      if(fseek(scores->journal, scores->journalOffset, SEEK_SET) == 0 &&
+         fwrite(batch, sizeof(JournalRecord), nbRecords,
+                scores->journal) == nbRecords &&
+         fflush(scores->journal) == 0 &&
+         fsync(fileno(scores->journal)) == 0){
+         scores->journalOffset += nbRecords * sizeof(JournalRecord);
+         scores->nbJournalRecords += nbRecords;
+         status = 0;
+      }
+   }
+
+   unlock_scores_file(scores);
+
+   return status;
+}
+
+
+static void *run_scores_writer(void *data) {
+   assert(data != NULL);
+
+   SavedScores *scores = (SavedScores *) data;
+   struct timespec deadline;
+
+   pthread_mutex_lock(&scores->lock);
+
+   while(scores->nbPending > 0 || !scores->stopping){
+      if(scores->nbPending == 0){
+         pthread_cond_wait(&scores->wakeUp, &scores->lock);
+         continue;
+      }
+
+      // A burst of changes is saved in one write.
+      get_deadline(SCORES_WRITE_DELAY_MS, &deadline);
+      while(!scores->flushRequested && !scores->stopping &&
+            pthread_cond_timedwait(&scores->wakeUp, &scores->lock,
+                                   &deadline) != ETIMEDOUT)
+         ;
+      scores->flushRequested = false;
+
+      pthread_mutex_unlock(&scores->lock);
+      int status = flush_pending_scores(scores);
+      pthread_mutex_lock(&scores->lock);
+
+      if(status != 0)
+         scores->failed = true;
+   }
+
+   scores->writerStopped = true;
+   pthread_cond_signal(&scores->stopped);
+   bool detached = scores->detached;
+
+   pthread_mutex_unlock(&scores->lock);
+
+   if(detached)
+      free_saved_scores(scores);
+
+   return NULL;
+}
+
+
+static void get_deadline(unsigned int delayMs, struct timespec *deadline) {
+   assert(deadline != NULL);
+
+   clock_gettime(CLOCK_REALTIME, deadline);
+   deadline->tv_sec += delayMs / 1000;
+   deadline->tv_nsec += (long) (delayMs % 1000) * 1000000;
+   if(deadline->tv_nsec >= 1000000000){
+      deadline->tv_sec++;
+      deadline->tv_nsec -= 1000000000;
+   }
+}
+
+
+static void free_saved_scores(SavedScores *scores) {
+   assert(scores != NULL);
+
+   if(scores->journal != NULL)
+      fclose(scores->journal);
+   if(scores->mapped)
+      munmap(scores->memory, scores->memorySize);
+   else
+      free(scores->memory);
+   // Closing the lock file releases the locks of every thread on it.
+   if(scores->lockFd >= 0){
+      pthread_mutex_lock(&scoresFilesLock);
+      close(scores->lockFd);
+      pthread_mutex_unlock(&scoresFilesLock);
+   }
+   pthread_cond_destroy(&scores->stopped);
+   pthread_cond_destroy(&scores->wakeUp);
+   pthread_mutex_destroy(&scores->lock);
+   free(scores->batch);
+   free(scores->pending);
+   free(scores->index);
+   free(scores->journalPath);
+   free(scores->filePath);
+   free(scores);
+}
+
+
+SavedScores *load_scores(const char *filePath, const char *importPath) {
+   assert(filePath != NULL);
+
+   SavedScores *save = malloc(sizeof(SavedScores));
+   if(save == NULL)
+      return NULL;
+
+   save->lockFd = -1;
+   save->journal = NULL;
+   save->journalOffset = 0;
+   save->nbJournalRecords = 0;
+   save->memory = NULL;
+   save->mapped = false;
+   save->index = NULL;
+   save->indexCapacity = 0;
+   save->nbIndexed = 0;
+   save->nbChanges = 0;
+   pthread_mutex_init(&save->lock, NULL);
+   pthread_cond_init(&save->wakeUp, NULL);
+   pthread_cond_init(&save->stopped, NULL);
+   save->writerRunning = false;
+   save->flushRequested = false;
+   save->stopping = false;
+   save->writerStopped = false;
+   save->detached = false;
+   save->failed = false;
+   save->pending = NULL;
+   save->nbPending = 0;
+   save->pendingCapacity = 0;
+   save->batch = NULL;
+   save->batchCapacity = 0;
+   save->filePath = create_path(filePath, "");
+   save->journalPath = create_path(filePath, SCORES_JOURNAL_SUFFIX);
+   if(save->filePath == NULL || save->journalPath == NULL){
+      destroy_saved_scores(save);
+      return NULL;
+   }
+
+   char *lockPath = create_path(filePath, SCORES_LOCK_SUFFIX);
+   if(lockPath == NULL){
+      destroy_saved_scores(save);
+      return NULL;
+   }
+   save->lockFd = open(lockPath, O_RDWR | O_CREAT, 0644);
+   free(lockPath);
+   if(save->lockFd < 0){
+      destroy_saved_scores(save);
+      return NULL;
+   }
+
+   if(lock_scores_file(save) != 0){
+      destroy_saved_scores(save);
+      return NULL;
+   }
+
+   int status = map_scores(save);
+   if(status == 1)
+      status = recover_scores(save);
+   if(status == 0)
+      status = replay_journal(save);
+
+   // The text scores are imported once, when nothing was saved since.
+   if(status == 0 && importPath != NULL && save->header->generation == 0 &&
+      save->header->length == 0)
+      status = import_text_scores(save, importPath);
+
+   unlock_scores_file(save);
+
+   if(status != 0){
+      fprintf(stderr, "Error while reading score file %s\n",
+              save->filePath);
+      destroy_saved_scores(save);
+      return NULL;
    }
 
-   return history;
+   return save;
 }
 
 
-static void destroy_history(History *history) {
-   if(history != NULL){
-      if(history->combinations != NULL){
-         for(unsigned int i = 0; i < history->nbCombinations; i++)
-            destroy_combination(history->combinations[i]);
-
-         free(history->combinations);
-      }
-      free(history);
-   }
-}
+int write_scores(SavedScores *scores) {
+   assert(scores != NULL);
 
+   pthread_mutex_lock(&scores->lock);
 
-static Combination **
-create_configs(unsigned int nbConfigs, unsigned int nbPawns) {
-   Combination **configs = malloc(nbConfigs * sizeof(Combination *));
-   if(configs == NULL)
-      return NULL;
+   bool writerRunning = scores->writerRunning;
+   if(writerRunning){
+      scores->flushRequested = true;
+      pthread_cond_signal(&scores->wakeUp);
+   }
+   bool failed = scores->failed;
+   scores->failed = false;
 
-   for(unsigned int i = 0; i < nbConfigs; i++){
-      configs[i] = create_combination(nbPawns);
-      if(configs[i] == NULL){
-         for(unsigned int j = 0; j < i; ++j)
-            destroy_combination(configs[i]);
+   pthread_mutex_unlock(&scores->lock);
 
-         free(configs);
-         return NULL;
-      }
+   // Without writer, the changes are saved by the caller.
+   if(!writerRunning && flush_pending_scores(scores) != 0)
+      failed = true;
 
-      unsigned int factor = i;
-      for(unsigned int j = 0; j < nbPawns; j++){
-         configs[i]->pawns[nbPawns - j - 1] = factor % (NB_PAWN_COLORS - 1);
-         factor /= (NB_PAWN_COLORS - 1);
-      }
+   if(failed){
+      fprintf(stderr, "Error while saving score");
+      return -1;
    }
 
-   return configs;
+   return 0;
 }
 
 
-static void update_score(ModelMastermind *mm) {
-   assert(mm != NULL);
+size_t get_feedback_table_size(unsigned int nbPawns) {
+   if(nbPawns > MAX_FEEDBACK_TABLE_PAWNS)
+      return 0;
 
-   bool alreadySavedPlayer = false;
+   size_t nbConfigs = pow(NB_CONFIG_COLORS, nbPawns);
 
-   for(unsigned i = 0; i < mm->save->length && !alreadySavedPlayer; i++){
-      if(!strcmp(mm->save->savedScores[i]->pseudo, mm->savedPseudo)){
-         mm->save->savedScores[i]->score += 1;
-         alreadySavedPlayer = true;
-      }
-   }
+   return nbConfigs * nbConfigs * sizeof(uint8_t);
+}
 
-   if(alreadySavedPlayer == false){
-      mm->save->length += 1;
-      Score **tmp = realloc(mm->save->savedScores,
-                            mm->save->length * sizeof(Score *));
-      if(tmp == NULL){
-         for(unsigned j = 0; j < mm->save->length - 1; j++)
-            free(mm->save->savedScores[j]);
 
-         free(mm->save->savedScores);
-         free(mm->save);
-      } else{
-         mm->save->savedScores = tmp;
-         mm->save->savedScores[mm->save->length - 1] = malloc(sizeof(Score));
-         if(mm->save->savedScores[mm->save->length - 1] == NULL){
-            for(unsigned j = 0; j < mm->save->length - 2; j++)
-               free(mm->save->savedScores[j]);
-            
-            free(mm->save->savedScores);
-            free(mm->save);
-         } 
-         
-         else{
-            strcpy(mm->save->savedScores[mm->save->length - 1]->pseudo,
-                   mm->savedPseudo);
-            mm->save->savedScores[mm->save->length - 1]->score = 1;
-         }
-      }
+void destroy_feedback_tables(void) {
+   pthread_mutex_lock(&feedbackTablesLock);
+
+   for(unsigned int i = 0; i <= MAX_FEEDBACK_TABLE_PAWNS; i++){
+      free(feedbackTables[i]);
+      feedbackTables[i] = NULL;
    }
+
+   pthread_mutex_unlock(&feedbackTablesLock);
 }
 
 
-ModelMainMenu *create_model_main_menu(void) {
-   ModelMainMenu *mmm = malloc(sizeof(ModelMainMenu));
-   if(mmm == NULL)
-      return NULL;
+bool is_feedback_kernel_supported(FEEDBACK_KERNEL kernel) {
+   assert(kernel < NB_FEEDBACK_KERNELS);
 
-   strcpy(mmm->pseudo, DEFAULT_PSEUDO);
-   mmm->validPseudo = false;
-   mmm->role = GUESSER;
-   mmm->nbPawns = DEFAULT_NB_PAWNS;
+   switch(kernel){
+      case FEEDBACK_KERNEL_AVX2:
+#ifdef FEEDBACK_SIMD
+         return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+#else
+         return false;
+#endif
 
-   return mmm;
+      case FEEDBACK_KERNEL_SCALAR:
+      default:
+         return true;
+   }
 }
 
 
-void destroy_model_main_menu(ModelMainMenu *mmm) {
-   if(mmm != NULL)
-      free(mmm);
-}
+int determine_feedback_keys(FEEDBACK_KERNEL kernel, unsigned int proposition,
+                            unsigned int nbPawns, unsigned char *keys) {
+   assert(kernel < NB_FEEDBACK_KERNELS && keys != NULL);
+   assert(nbPawns >= 1 && nbPawns <= MAX_NB_PAWNS);
 
+   if(!is_feedback_kernel_supported(kernel))
+      return -1;
 
-ModelMastermind *create_model_mastermind(ModelMainMenu *mmm) {
-   ModelMastermind *mm = malloc(sizeof(ModelMastermind));
-   if(mm == NULL)
-      return NULL;
+   unsigned int nbConfigs = pow(NB_CONFIG_COLORS, nbPawns);
+   assert(proposition < nbConfigs);
 
-   // Copy main menu settings in game model.
-   mm->role = mmm->role;
-   strcpy(mm->savedPseudo, mmm->pseudo);
-   mm->inGame = true;
-   mm->selectedColor = PAWN_BLUE;
-   mm->validSolution = false;
+   uint32_t code = decode_config(proposition, nbPawns);
+   uint32_t solutions[FEEDBACK_BLOCK];
+   uint32_t solution = decode_config(0, nbPawns);
 
-   mm->proposition = create_combination(mmm->nbPawns);
-   if(mm->proposition == NULL){
-      free(mm);
-      return NULL;
-   }
+   // Solutions are enumerated block by block, as by filter_survivors().
+   for(unsigned int i = 0; i < nbConfigs; i += FEEDBACK_BLOCK){
+      unsigned int blockLength = nbConfigs - i;
+      if(blockLength > FEEDBACK_BLOCK)
+         blockLength = FEEDBACK_BLOCK;
 
-   mm->solution = malloc(mmm->nbPawns * sizeof(PAWN_COLOR));
-   if(mm->solution == NULL){
-      destroy_combination(mm->proposition);
-      free(mm);
-      return NULL;
-   }
+      for(unsigned int k = 0; k < blockLength; k++){
+         solutions[k] = solution;
+         solution = next_config(solution, nbPawns);
+      }
 
-   mm->feedback = malloc(mmm->nbPawns * sizeof(FEEDBACK_COLOR));
-   if(mm->feedback == NULL){
-      free(mm->solution);
-      destroy_combination(mm->proposition);
-      free(mm);
-      return NULL;
+#ifdef FEEDBACK_SIMD
+      if(kernel == FEEDBACK_KERNEL_AVX2){
+         determine_feedback_batch_avx2(code, solutions, blockLength, nbPawns,
+                                       keys + i);
+         continue;
+      }
+#endif
+      determine_feedback_batch_scalar(code, solutions, blockLength, nbPawns,
+                                      keys + i);
    }
 
-   for(unsigned int i = 0; i < mmm->nbPawns; i++){
-      mm->solution[i] = PAWN_DEFAULT;
-      mm->feedback[i] = FB_DEFAULT;
-   }
+   return 0;
+}
 
-   mm->history = create_history(mmm->nbPawns, NB_COMBINATIONS);
-   if(mm->history == NULL){
-      free(mm->feedback);
-      free(mm->solution);
-      destroy_combination(mm->proposition);
-      free(mm);
-      return NULL;
-   }
 
-   mm->nbConfigs = pow(NB_PAWN_COLORS, mm->history->nbPawns);
-   mm->lastConfigIndex = 1;
+int load_opening_book(const char *filePath) {
+   assert(filePath != NULL);
 
-   mm->configs = create_configs(mm->nbConfigs, mm->history->nbPawns);
-   if(mm->configs == NULL){
-      destroy_history(mm->history);
-      free(mm->feedback);
-      free(mm->solution);
-      destroy_combination(mm->proposition);
-      free(mm);
-      return NULL;
+   FILE *pFile = fopen(filePath, "r");
+   if(pFile == NULL)
+      return -1;
+
+   char line[BOOK_LINE_LENGTH];
+   char pawns[MAX_NB_PAWNS + 2];
+   unsigned int solver, nbPawns, nbCorrect, nbMisplaced;
+   uint32_t code;
+   int status = 0;
+
+   memset(openingBooks, 0, sizeof(openingBooks));
+
+   while(status == 0 && fgets(line, sizeof(line), pFile) != NULL){
+      if(line[0] == '#' || line[0] == '\n')
+         continue;
+
+      if(sscanf(line, "first %u %u %9s", &solver, &nbPawns, pawns) == 3 &&
+         solver < NB_SOLVERS && nbPawns >= MIN_NB_PAWNS &&
+         nbPawns <= MAX_NB_PAWNS && parse_book_code(pawns, nbPawns, &code))
+         openingBooks[solver].first[nbPawns] = code | BOOK_ENTRY_SET;
+      else if(sscanf(line, "second %u %u %u %u %9s", &solver, &nbPawns,
+                     &nbCorrect, &nbMisplaced, pawns) == 5 &&
+              solver < NB_SOLVERS && nbPawns >= MIN_NB_PAWNS &&
+              nbPawns <= MAX_NB_PAWNS && nbCorrect + nbMisplaced <= nbPawns &&
+              parse_book_code(pawns, nbPawns, &code))
+         openingBooks[solver].second[nbPawns][nbCorrect * (MAX_NB_PAWNS + 1) +
+                                              nbMisplaced] =
+            code | BOOK_ENTRY_SET;
+      else
+         status = -1;
    }
 
-   mm->save = load_scores(SAVED_SCORES_PATH);
-   if(mm->save == NULL){
-      free(mm->solution);
-      free(mm->proposition);
-      destroy_configs(mm->configs, mm->history->nbPawns);
-      destroy_history(mm->history);
-      free(mm);
-      return NULL;
+   if(status != 0){
+      fprintf(stderr, "Invalid opening book line: %s", line);
+      memset(openingBooks, 0, sizeof(openingBooks));
    }
 
-   return mm;
+   fclose(pFile);
+   return status;
 }
 
 
-void destroy_model_mastermind(ModelMastermind *mm) {
-   if(mm != NULL){
-      if(mm->proposition != NULL)
-         destroy_combination(mm->proposition);
-      if(mm->solution != NULL)
-         free(mm->solution);
-      if(mm->feedback != NULL)
-         free(mm->feedback);
-      if(mm->configs != NULL)
-         destroy_configs(mm->configs, mm->history->nbPawns);
-      destroy_history(mm->history);
-      if(mm->save != NULL)
-         destroy_saved_scores(mm->save);
-      free(mm);
-   }
-}
+bool generate_opening_book(ModelMainMenu *mmm, unsigned long long maxWork) {
+   assert(mmm != NULL && mmm->solver < NB_SOLVERS && maxWork > 0);
 
-static void destroy_configs(Combination **configs, unsigned int nbConfigs) {
-   assert(configs != NULL);
+   // The first consistent solver has nothing to precompute.
+   if(mmm->solver == SOLVER_FIRST_CONSISTENT)
+      return false;
 
-   for(unsigned int i = 0; i < nbConfigs; ++i){
-      destroy_combination(configs[i]);
-   }
+   ModelMastermind *mm = create_model_mastermind(mmm);
+   if(mm == NULL)
+      return false;
 
-   free(configs);
-}
+   mm->solverMaxWork = maxWork;
+   mm->useOpeningBook = false;
 
-SavedScores *load_scores(const char *filePath) {
-   assert(filePath != NULL);
+   OpeningBook *book = &openingBooks[mm->solver];
+   unsigned int nbPawns = mm->history.nbPawns;
+   int firstIndex = mm->history.nbCombinations - 1;
+   uint32_t opener;
 
-   SavedScores *save = malloc(sizeof(SavedScores));
-   if(save == NULL)
-      return NULL;
+   if(!find_best_proposition(mm, &opener)){
+      destroy_model_mastermind(mm);
+      return false;
+   }
 
-   if(access(filePath, F_OK) == 0){
-      FILE *pFile = fopen(filePath, "r");
-      if(pFile == NULL)
-         return NULL;
+   book->first[nbPawns] = opener | BOOK_ENTRY_SET;
+   mm->history.codes[firstIndex] = opener;
+   mm->history.currentIndex = firstIndex - 1;
 
-      if(!fscanf(pFile, "%u\n", &save->length)){
-         free(save);
-         fclose(pFile);
-         return NULL;
-      }
+   bool success = true;
+   for(unsigned int key = 0; key < NB_FEEDBACK_KEYS && success; key++){
+      book->second[nbPawns][key] = 0;
 
-      save->savedScores = malloc(save->length * sizeof(Score *));
-      if(save->savedScores == NULL){
-         free(save);
-         fclose(pFile);
-         return NULL;
-      }
+      unsigned int nbCorrect = key / (MAX_NB_PAWNS + 1);
+      unsigned int nbMisplaced = key % (MAX_NB_PAWNS + 1);
+      if(nbCorrect + nbMisplaced > nbPawns || nbCorrect == nbPawns)
+         continue;
 
-      for(unsigned i = 0; save->length > i; i++){
-         save->savedScores[i] = malloc(sizeof(Score));
-         if(save->savedScores[i] == NULL){
-            for(unsigned j = 0; j < i; j++)
-               free(save->savedScores[j]);
+      mm->history.nbCorrect[firstIndex] = nbCorrect;
+      mm->history.nbMisplaced[firstIndex] = nbMisplaced;
 
-            free(save->savedScores);
-            free(save);
-            fclose(pFile);
-            return NULL;
-         }
-         if(!fscanf(pFile, "%s %u\n", save->savedScores[i]->pseudo,
-                    &save->savedScores[i]->score)){
-            for(unsigned j = 0; j < i; j++)
-               free(save->savedScores[j]);
-
-            free(save);
-            fclose(pFile);
-            return NULL;
-         }
-      }
-   } else{
-      save->length = 0;
-      save->savedScores = malloc(sizeof(Score *));
-      if(save->savedScores == NULL){
-         free(save);
-         return NULL;
+      free(mm->survivors);
+      mm->survivors = NULL;
+      filter_survivors(mm, opener, nbCorrect, nbMisplaced);
+      if(mm->survivors == NULL){
+         success = false;
+         continue;
       }
+
+      // Too few survivors to be worth a book entry.
+      if(mm->nbSurvivors <= 2)
+         continue;
+
+      uint32_t second;
+      if(find_best_proposition(mm, &second))
+         book->second[nbPawns][key] = second | BOOK_ENTRY_SET;
+      else
+         success = false;
    }
 
-   return save;
+   destroy_model_mastermind(mm);
+   return success;
 }
 
 
-int write_scores(SavedScores *scores, const char *filePath) {
-   assert(scores != NULL && filePath != NULL);
+int write_opening_book(const char *filePath) {
+   assert(filePath != NULL);
 
    FILE *pFile = fopen(filePath, "w");
    if(pFile == NULL){
-      fprintf(stderr, "Error while saving score");
+      fprintf(stderr, "Error while saving opening book");
       return -1;
    }
 
-   fprintf(pFile, "%u\n", scores->length);
+   char pawns[MAX_NB_PAWNS + 1];
+
+   fprintf(pFile, "# Mastermind opening book, generated by mastermind-book.\n");
+   fprintf(pFile, "# first <solver> <pawns> <proposition>\n");
+   fprintf(pFile, "# second <solver> <pawns> <correct> <misplaced> "
+                  "<proposition>\n");
+
+   for(unsigned int solver = 0; solver < NB_SOLVERS; solver++){
+      const OpeningBook *book = &openingBooks[solver];
 
-   for(unsigned i = 0; i < scores->length; i++){
-      fprintf(pFile, "%s %u\n", scores->savedScores[i]->pseudo,
-              scores->savedScores[i]->score);
+      for(unsigned int nbPawns = MIN_NB_PAWNS; nbPawns <= MAX_NB_PAWNS;
+          nbPawns++){
+         if(!(book->first[nbPawns] & BOOK_ENTRY_SET))
+            continue;
+
+         format_book_code(book->first[nbPawns], nbPawns, pawns);
+         fprintf(pFile, "first %u %u %s\n", solver, nbPawns, pawns);
+
+         for(unsigned int key = 0; key < NB_FEEDBACK_KEYS; key++){
+            if(!(book->second[nbPawns][key] & BOOK_ENTRY_SET))
+               continue;
+
+            format_book_code(book->second[nbPawns][key], nbPawns, pawns);
+            fprintf(pFile, "second %u %u %u %u %s\n", solver, nbPawns,
+                    key / (MAX_NB_PAWNS + 1), key % (MAX_NB_PAWNS + 1), pawns);
+         }
+      }
    }
 
-   fclose(pFile);
+   if(fclose(pFile) != 0)
+      return -1;
+
    return 0;
 }
 
@@ -537,17 +3277,16 @@ int write_scores(SavedScores *scores, const char *filePath) {
 void generate_random_solution(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   srand(time(NULL));
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
-      mm->solution[i] = rand() % (NB_PAWN_COLORS - 1);
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++)
+      mm->solution[i] = next_random(&mm->randomState) % (NB_PAWN_COLORS - 1);
 }
 
 
 bool verify_proposition(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
-      if(mm->proposition->pawns[i] == PAWN_DEFAULT)
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++)
+      if(mm->proposition.pawns[i] == PAWN_DEFAULT)
          return false;
 
    return true;
@@ -557,18 +3296,18 @@ bool verify_proposition(ModelMastermind *mm) {
 void reset_proposition(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   mm->proposition->nbCorrect = 0;
-   mm->proposition->nbMisplaced = 0;
+   mm->proposition.nbCorrect = 0;
+   mm->proposition.nbMisplaced = 0;
 
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
-      mm->proposition->pawns[i] = PAWN_DEFAULT;
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++)
+      mm->proposition.pawns[i] = PAWN_DEFAULT;
 }
 
 
 void reset_feedback(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++)
       mm->feedback[i] = FB_DEFAULT;
 }
 
@@ -578,37 +3317,21 @@ determine_feedback_proposition(ModelMastermind *mm, Combination *proposition,
                                const PAWN_COLOR *solution) {
    assert(mm != NULL && proposition != NULL && solution != NULL);
 
-   unsigned int nbColorsInProposition[NB_PAWN_COLORS];
-   unsigned int nbColorsInSolution[NB_PAWN_COLORS];
+   unsigned int nbCorrect;
+   unsigned int nbMisplaced;
 
-   for(unsigned int i = 0; i < NB_PAWN_COLORS; i++){
-      nbColorsInProposition[i] = 0;
-      nbColorsInSolution[i] = 0;
-   }
-
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++){
-      if(proposition->pawns[i] == solution[i])
-         proposition->nbCorrect++;
-
-      else{
-         nbColorsInProposition[proposition->pawns[i]]++;
-         nbColorsInSolution[solution[i]]++;
-      }
-   }
-
-   for(unsigned int i = 0; i < NB_PAWN_COLORS; i++){
-      if(nbColorsInProposition[i] < nbColorsInSolution[i])
-         proposition->nbMisplaced += nbColorsInProposition[i];
-      else
-         proposition->nbMisplaced += nbColorsInSolution[i];
-   }
+   determine_feedback_code(pack_pawns(proposition->pawns, mm->history.nbPawns),
+                           pack_solution(solution, mm->history.nbPawns),
+                           mm->history.nbPawns, &nbCorrect, &nbMisplaced);
+   proposition->nbCorrect = nbCorrect;
+   proposition->nbMisplaced = nbMisplaced;
 }
 
 
 void update_current_combination_index(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   mm->history->currentIndex--;
+   mm->history.currentIndex--;
 }
 
 
@@ -618,7 +3341,7 @@ void update_last_combination_feedback(ModelMastermind *mm) {
    unsigned int nbCorrect = 0;
    unsigned int nbMisplaced = 0;
 
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++){
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++){
       if(mm->feedback[i] == FB_BLACK)
          nbCorrect += 1;
 
@@ -626,53 +3349,29 @@ void update_last_combination_feedback(ModelMastermind *mm) {
          nbMisplaced += 1;
    }
 
-   mm->history->combinations[mm->history->currentIndex]->nbCorrect = nbCorrect;
-   mm->history->combinations[mm->history->currentIndex]->nbMisplaced = nbMisplaced;
+   set_last_combination_feedback(mm, nbCorrect, nbMisplaced);
 }
 
 
 void find_next_proposition(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   int nbCombi = mm->history->nbCombinations - 1;
-
-   if(mm->history->currentIndex == nbCombi)
-      for(unsigned int j = 0; j < mm->history->nbPawns; j++)
-         mm->proposition->pawns[j] = mm->configs[0]->pawns[j];
-
-   else{
-      int nextCombiIndex = -1;
-      for(unsigned int i = mm->lastConfigIndex;
-          nextCombiIndex == -1 && i < mm->nbConfigs; i++){
-         determine_feedback_proposition(mm, mm->configs[i],
-                                        mm->history->combinations[
-                                                mm->history->currentIndex +
-                                                1]->pawns);
-
-         if(mm->configs[i]->nbCorrect ==
-            mm->history->combinations[mm->history->currentIndex +
-                                      1]->nbCorrect &&
-            mm->configs[i]->nbMisplaced ==
-            mm->history->combinations[mm->history->currentIndex +
-                                      1]->nbMisplaced)
-            nextCombiIndex = i;
-      }
-
-      if(nextCombiIndex != -1){
-         for(unsigned int j = 0; j < mm->history->nbPawns; j++)
-            mm->proposition->pawns[j] = mm->configs[nextCombiIndex]->pawns[j];
+   uint32_t proposition;
 
-         mm->lastConfigIndex = nextCombiIndex + 1;
-      }
-   }
+   // Keeps the previous proposition if the feedbacks are contradictory.
+   if(mm->solver != SOLVER_FIRST_CONSISTENT &&
+      find_best_proposition(mm, &proposition))
+      unpack_code(proposition, mm->history.nbPawns, mm->proposition.pawns);
+   else if(find_first_consistent(mm, &proposition))
+      unpack_code(proposition, mm->history.nbPawns, mm->proposition.pawns);
 }
 
 
 void verify_end_game(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   if(mm->history->combinations[mm->history->currentIndex]->nbCorrect ==
-      mm->history->nbPawns || mm->history->currentIndex <= 0)
+   if(mm->history.nbCorrect[mm->history.currentIndex] ==
+      mm->history.nbPawns || mm->history.currentIndex <= 0)
       mm->inGame = false;
 
    update_score(mm);
@@ -710,7 +3409,7 @@ bool get_valid_solution(ModelMastermind *mm) {
 Combination *get_proposition(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   return mm->proposition;
+   return &mm->proposition;
 }
 
 
@@ -724,47 +3423,71 @@ PAWN_COLOR *get_solution(ModelMastermind *mm) {
 unsigned int get_nb_pawns(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   return mm->history->nbPawns;
+   return mm->history.nbPawns;
 }
 
 
 unsigned int get_nb_combinations(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   return mm->history->nbCombinations;
+   return mm->history.nbCombinations;
 }
 
 
 int get_current_index(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   return mm->history->currentIndex;
+   return mm->history.currentIndex;
+}
+
+
+PAWN_COLOR get_pawn_combination(ModelMastermind *mm, unsigned int index,
+                                unsigned int pawnIndex) {
+   assert(mm != NULL && index < mm->history.nbCombinations &&
+          pawnIndex < mm->history.nbPawns);
+
+   return (mm->history.codes[index] >> (pawnIndex * PAWN_BITS)) & PAWN_MASK;
 }
 
 
 PAWN_COLOR
 get_pawn_last_combination(ModelMastermind *mm, unsigned int pawnIndex) {
-   assert(mm != NULL && pawnIndex < mm->history->nbPawns);
+   assert(mm != NULL);
 
-   return mm->history->combinations[mm->history->currentIndex]->pawns[pawnIndex];
+   return get_pawn_combination(mm, mm->history.currentIndex, pawnIndex);
 }
 
 
 unsigned int get_nb_correct_last_combination(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   int index = mm->history->currentIndex;
+   int index = mm->history.currentIndex;
    if(index < 0)
       index = 0;
 
-   return mm->history->combinations[index]->nbCorrect;
+   return mm->history.nbCorrect[index];
 }
 
 
 unsigned int get_nb_misplaced_last_combination(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   return mm->history->combinations[mm->history->currentIndex]->nbMisplaced;
+   return mm->history.nbMisplaced[mm->history.currentIndex];
+}
+
+
+unsigned int get_nb_correct_combination(ModelMastermind *mm, unsigned int index) {
+   assert(mm != NULL && index < mm->history.nbCombinations);
+
+   return mm->history.nbCorrect[index];
+}
+
+
+unsigned int get_nb_misplaced_combination(ModelMastermind *mm,
+                                          unsigned int index) {
+   assert(mm != NULL && index < mm->history.nbCombinations);
+
+   return mm->history.nbMisplaced[index];
 }
 
 
@@ -778,11 +3501,11 @@ FEEDBACK_COLOR get_feedback_pawn(ModelMastermind *mm, unsigned int index) {
 void set_proposition_in_history(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   mm->history->combinations[mm->history->currentIndex]->nbCorrect = mm->proposition->nbCorrect;
-   mm->history->combinations[mm->history->currentIndex]->nbMisplaced = mm->proposition->nbMisplaced;
-
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
-      mm->history->combinations[mm->history->currentIndex]->pawns[i] = mm->proposition->pawns[i];
+   History *history = &mm->history;
+   history->codes[history->currentIndex] = pack_pawns(mm->proposition.pawns,
+                                                      history->nbPawns);
+   history->nbCorrect[history->currentIndex] = mm->proposition.nbCorrect;
+   history->nbMisplaced[history->currentIndex] = mm->proposition.nbMisplaced;
 }
 
 
@@ -798,6 +3521,36 @@ void set_nb_pawns_slider(ModelMainMenu *mmm, unsigned int nbPawns) {
 }
 
 
+void set_seed(ModelMainMenu *mmm, unsigned int seed) {
+   assert(mmm != NULL);
+   mmm->seed = seed;
+}
+
+
+void set_save_scores(ModelMainMenu *mmm, bool saveScores) {
+   assert(mmm != NULL);
+   mmm->saveScores = saveScores;
+}
+
+
+void set_solver(ModelMainMenu *mmm, SOLVER solver) {
+   assert(mmm != NULL && solver < NB_SOLVERS);
+   mmm->solver = solver;
+}
+
+
+void set_solver_threads(ModelMainMenu *mmm, unsigned int nbThreads) {
+   assert(mmm != NULL);
+   mmm->nbSolverThreads = nbThreads;
+}
+
+
+void set_feedback_table_max_pawns(ModelMainMenu *mmm, unsigned int maxPawns) {
+   assert(mmm != NULL);
+   mmm->feedbackTableMaxPawns = maxPawns;
+}
+
+
 void set_pseudo(ModelMainMenu *mmm, char *pseudo) {
    assert(mmm != NULL && strlen(pseudo) <= MAX_PSEUDO_LENGTH);
    strcpy(mmm->pseudo, pseudo);
@@ -811,16 +3564,16 @@ void set_selected_color(ModelMastermind *mm, PAWN_COLOR newColor) {
 
 
 void set_proposition_pawn_selected_color(ModelMastermind *mm, unsigned int i) {
-   assert(mm != NULL && i < mm->history->nbPawns);
-   mm->proposition->pawns[i] = mm->selectedColor;
+   assert(mm != NULL && i < mm->history.nbPawns);
+   mm->proposition.pawns[i] = mm->selectedColor;
 }
 
 
 void set_proposition_as_solution(ModelMastermind *mm) {
    assert(mm != NULL);
 
-   for(unsigned int i = 0; i < mm->history->nbPawns; i++)
-      mm->solution[i] = mm->proposition->pawns[i];
+   for(unsigned int i = 0; i < mm->history.nbPawns; i++)
+      mm->solution[i] = mm->proposition.pawns[i];
 }
 
 
@@ -831,6 +3584,19 @@ void set_feedback_pawn(ModelMastermind *mm, unsigned int index) {
 }
 
 
+void set_last_combination_feedback(ModelMastermind *mm, unsigned int nbCorrect,
+                                   unsigned int nbMisplaced) {
+   assert(mm != NULL && nbCorrect + nbMisplaced <= mm->history.nbPawns);
+
+   History *history = &mm->history;
+   history->nbCorrect[history->currentIndex] = nbCorrect;
+   history->nbMisplaced[history->currentIndex] = nbMisplaced;
+
+   filter_survivors(mm, history->codes[history->currentIndex], nbCorrect,
+                    nbMisplaced);
+}
+
+
 void set_valid_solution_true(ModelMastermind *mm) {
    assert(mm != NULL);
 
@@ -846,17 +3612,26 @@ SavedScores *get_saved_scores(ModelMastermind *mm) {
 
 unsigned get_saved_scores_length(ModelMastermind *mm) {
    assert(mm != NULL);
-   return mm->save->length;
+
+   if(mm->save == NULL)
+      return 0;
+
+   pthread_mutex_lock(&mm->save->lock);
+   unsigned length = mm->save->header->length;
+   pthread_mutex_unlock(&mm->save->lock);
+
+   return length;
 }
 
 
-char **get_scores_strings(SavedScores *scores) {
-   assert(scores != NULL);
+char **get_scores_strings(SavedScores *scores, unsigned *length) {
+   assert(scores != NULL && length != NULL);
 
-   qsort(scores->savedScores, scores->length, sizeof(Score), compare_scores);
+   // The scores of other processes are applied by the writer.
+   pthread_mutex_lock(&scores->lock);
 
-   unsigned size = (scores->length < MAX_SCORE_DISPLAYED) ? scores->length
-                                                          : MAX_SCORE_DISPLAYED;
+   const ScoresHeader *header = scores->header;
+   unsigned size = header->nbTop;
 
    char **strings = malloc(size * sizeof(char *));
    if(strings == NULL){
@@ -870,14 +3645,29 @@ char **get_scores_strings(SavedScores *scores) {
          fprintf(stderr, "Memory allocation failed for a score string\n");
          exit(1);
       }
-      sprintf(strings[i], "%u. %s   %u", i + 1, scores->savedScores[i]->pseudo,
-              scores->savedScores[i]->score);
+      const Score *score = &scores->records[header->top[i]];
+      sprintf(strings[i], "%u. %.*s   %u", i + 1, MAX_PSEUDO_LENGTH,
+              score->pseudo, (unsigned) score->score);
    }
 
+   pthread_mutex_unlock(&scores->lock);
+
+   *length = size;
    return strings;
 }
 
 
+unsigned long get_scores_changes(SavedScores *scores) {
+   assert(scores != NULL);
+
+   pthread_mutex_lock(&scores->lock);
+   unsigned long nbChanges = scores->nbChanges;
+   pthread_mutex_unlock(&scores->lock);
+
+   return nbChanges;
+}
+
+
 void free_scores_strings(char **strings, unsigned length) {
    assert(strings != NULL);
 
@@ -891,23 +3681,243 @@ void free_scores_strings(char **strings, unsigned length) {
 static int compare_scores(const void *a, const void *b) {
    assert(a != NULL && b != NULL);
 
-   const Score *pScore1 = (const Score *) a;
-   const Score *pScore2 = (const Score *) b;
+   const Score *pScore1 = *(const Score * const *) a;
+   const Score *pScore2 = *(const Score * const *) b;
 
    if(pScore1->score < pScore2->score)
       return 1;
    else if(pScore1->score > pScore2->score)
       return -1;
    else
-      return 0;
+      return strncmp(pScore1->pseudo, pScore2->pseudo, MAX_PSEUDO_LENGTH);
+}
+
+
+static void update_top_scores(SavedScores *scores, uint32_t record) {
+   assert(scores != NULL && record < scores->header->length);
+
+   ScoresHeader *header = scores->header;
+   const Score *score = &scores->records[record];
+   const Score *other;
+
+   uint32_t position = 0;
+   while(position < header->nbTop && header->top[position] != record)
+      position++;
+
+   if(position == header->nbTop){
+      if(header->nbTop < MAX_SCORE_DISPLAYED)
+         header->nbTop++;
+      else{
+         other = &scores->records[header->top[header->nbTop - 1]];
+         if(compare_scores(&score, &other) >= 0)
+            return;
+      }
+      // The new record replaces the last one.
+      position = header->nbTop - 1;
+   }
+
+   while(position > 0){
+      other = &scores->records[header->top[position - 1]];
+      if(compare_scores(&score, &other) >= 0)
+         break;
+
+      header->top[position] = header->top[position - 1];
+      position--;
+   }
+   header->top[position] = record;
+}
+
+
+static uint32_t hash_pseudo(const char *pseudo) {
+   assert(pseudo != NULL);
+
+   uint32_t hash = 2166136261u;
+   for(unsigned i = 0; i < MAX_PSEUDO_LENGTH && pseudo[i] != '\0'; i++){
+      hash ^= (unsigned char) pseudo[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+
+static void insert_score_slot(ScoreSlot *index, uint32_t capacity,
+                              uint32_t hash, uint32_t record) {
+   assert(index != NULL);
+
+   uint32_t slot = hash & (capacity - 1);
+   while(index[slot].record != 0)
+      slot = (slot + 1) & (capacity - 1);
+
+   index[slot].hash = hash;
+   index[slot].record = record + 1;
+}
+
+
+static int update_score_index(SavedScores *scores) {
+   assert(scores != NULL);
+
+   uint32_t length = scores->header->length;
+
+   if(2 * (unsigned long long) (length + 1) > scores->indexCapacity){
+      uint32_t capacity = (scores->indexCapacity > 0)
+                          ? scores->indexCapacity : SCORES_INDEX_MIN_CAPACITY;
+      while(2 * (unsigned long long) (length + 1) > capacity)
+         capacity *= 2;
+
+      ScoreSlot *index = calloc(capacity, sizeof(ScoreSlot));
+      if(index == NULL)
+         return -1;
+
+      for(uint32_t i = 0; i < scores->indexCapacity; i++)
+         if(scores->index[i].record != 0)
+            insert_score_slot(index, capacity, scores->index[i].hash,
+                              scores->index[i].record - 1);
+
+      free(scores->index);
+      scores->index = index;
+      scores->indexCapacity = capacity;
+   }
+
+   for(; scores->nbIndexed < length; scores->nbIndexed++)
+      insert_score_slot(scores->index, scores->indexCapacity,
+                        hash_pseudo(scores->records[scores->nbIndexed].pseudo),
+                        scores->nbIndexed);
+
+   return 0;
+}
+
+
+static int apply_score(SavedScores *scores, const char *pseudo, unsigned points) {
+   assert(scores != NULL && pseudo != NULL);
+
+   // Also leaves room for a new player.
+   if(update_score_index(scores) != 0)
+      return -1;
+
+   uint32_t hash = hash_pseudo(pseudo);
+   uint32_t mask = scores->indexCapacity - 1;
+
+   for(uint32_t slot = hash & mask; scores->index[slot].record != 0;
+       slot = (slot + 1) & mask){
+      Score *score = &scores->records[scores->index[slot].record - 1];
+      if(scores->index[slot].hash == hash &&
+         !strncmp(score->pseudo, pseudo, MAX_PSEUDO_LENGTH)){
+         score->score += points;
+         update_top_scores(scores, scores->index[slot].record - 1);
+         scores->nbChanges++;
+         return 0;
+      }
+   }
+
+   if(scores->header->length == scores->header->capacity &&
+      grow_scores(scores) != 0)
+      return -1;
+
+   ScoresHeader *header = scores->header;
+   Score *score = &scores->records[header->length];
+   memset(score, 0, sizeof(Score));
+   snprintf(score->pseudo, sizeof(score->pseudo), "%s", pseudo);
+   score->score = points;
+
+   insert_score_slot(scores->index, scores->indexCapacity, hash,
+                     header->length);
+   scores->nbIndexed = ++header->length;
+   update_top_scores(scores, header->length - 1);
+   scores->nbChanges++;
+
+   return 0;
+}
+
+
+int record_score(SavedScores *scores, const char *pseudo, unsigned points) {
+   assert(scores != NULL && pseudo != NULL);
+
+   // Games without score do not need a writer.
+   if(!scores->writerRunning && scores->journal != NULL)
+      scores->writerRunning = pthread_create(&scores->writer, NULL,
+                                             run_scores_writer, scores) == 0;
+
+   pthread_mutex_lock(&scores->lock);
+
+   JournalRecord *last = (scores->nbPending > 0)
+                         ? &scores->pending[scores->nbPending - 1] : NULL;
+   int status = 0;
+
+   if(last != NULL && !strncmp(last->pseudo, pseudo, MAX_PSEUDO_LENGTH)){
+      // A player winning games in a row adds to the same record.
+      if(apply_score(scores, pseudo, points) == 0){
+         last->delta += points;
+         last->timestamp = time(NULL);
+      } else
+         status = -1;
+   } else{
+      if(scores->nbPending == scores->pendingCapacity){
+         uint32_t capacity = (scores->pendingCapacity > 0)
+                             ? scores->pendingCapacity * 2 : 16;
+         JournalRecord *pending = realloc(scores->pending,
+                                          capacity * sizeof(JournalRecord));
+         if(pending != NULL){
+            scores->pending = pending;
+            scores->pendingCapacity = capacity;
+         }
+      }
+
+      if(scores->nbPending < scores->pendingCapacity &&
+         apply_score(scores, pseudo, points) == 0){
+         JournalRecord *record = &scores->pending[scores->nbPending++];
+         memset(record, 0, sizeof(JournalRecord));
+         snprintf(record->pseudo, sizeof(record->pseudo), "%s", pseudo);
+         record->delta = points;
+         record->timestamp = time(NULL);
+      } else
+         status = -1;
+   }
+
+   // The writer only waits for changes when there is none pending.
+   if(status == 0 && scores->writerRunning && scores->nbPending == 1 &&
+      last == NULL)
+      pthread_cond_signal(&scores->wakeUp);
+
+   pthread_mutex_unlock(&scores->lock);
+
+   return status;
 }
 
 
 void destroy_saved_scores(SavedScores *scores) {
    assert(scores != NULL);
 
-   for(unsigned j = 0; j < scores->length; j++)
-      free(scores->savedScores[j]);
+   if(!scores->writerRunning){
+      if(flush_pending_scores(scores) != 0)
+         fprintf(stderr, "Error while saving score");
+      free_saved_scores(scores);
+      return;
+   }
+
+   struct timespec deadline;
+   get_deadline(SCORES_FLUSH_TIMEOUT_MS, &deadline);
 
-   free(scores);
+   pthread_mutex_lock(&scores->lock);
+
+   scores->stopping = true;
+   pthread_cond_signal(&scores->wakeUp);
+   while(!scores->writerStopped &&
+         pthread_cond_timedwait(&scores->stopped, &scores->lock,
+                                &deadline) != ETIMEDOUT)
+      ;
+
+   // A writer stuck on a slow disk frees the scores once it is done.
+   bool writerStopped = scores->writerStopped;
+   scores->detached = !writerStopped;
+
+   pthread_mutex_unlock(&scores->lock);
+
+   if(writerStopped){
+      pthread_join(scores->writer, NULL);
+      if(scores->failed)
+         fprintf(stderr, "Error while saving score");
+      free_saved_scores(scores);
+   } else
+      pthread_detach(scores->writer);
 }
@@ -11,6 +11,7 @@
  * */
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #ifndef __MODEL_MASTERMIND__
 #define __MODEL_MASTERMIND__
@@ -18,7 +19,28 @@
 /**
  * \brief Path of the file where the scores are saved
  */
-#define SAVED_SCORES_PATH "./source/scores.txt"
+#define SAVED_SCORES_PATH "./source/scores.bin"
+
+/**
+ * \brief Suffix of the journal path to the path of its score file
+ */
+#define SCORES_JOURNAL_SUFFIX "-journal"
+
+/**
+ * \brief Path of the text file where the previous versions saved the scores,
+ * imported by the first load of the scores
+ */
+#define LEGACY_SCORES_PATH "./source/scores.txt"
+
+/**
+ * \brief Suffix of the lock file path to the path of its score file
+ */
+#define SCORES_LOCK_SUFFIX "-lock"
+
+/**
+ * \brief Path of the opening book of the solvers (see load_opening_book())
+ */
+#define OPENING_BOOK_PATH "./opening_book.txt"
 
 /**
  * \brief Default player pseudo.
@@ -93,6 +115,46 @@ typedef enum {
     PROPOSER /*!< Proposer role */
 } ROLE;
 
+/**
+ * \brief Defines the strategies the computer can use to find its propositions.
+*/
+typedef enum {
+    SOLVER_FIRST_CONSISTENT, /*!< First configuration consistent with the history */
+    SOLVER_MINIMAX,          /*!< Knuth's minimax on the worst feedback partition */
+    SOLVER_ENTROPY,          /*!< Maximum entropy of the feedback partition */
+    SOLVER_EXPECTED_SIZE,    /*!< Minimum expected size of the feedback partition */
+    NB_SOLVERS               /*!< Number of solvers */
+} SOLVER;
+
+/**
+ * \brief Defines the kernels scoring a proposition against many solutions.
+*/
+typedef enum {
+    FEEDBACK_KERNEL_SCALAR, /*!< Portable kernel, one solution at a time */
+    FEEDBACK_KERNEL_AVX2,   /*!< AVX2 kernel, four solutions at once */
+    NB_FEEDBACK_KERNELS     /*!< Number of feedback kernels */
+} FEEDBACK_KERNEL;
+
+/**
+ * \brief Default solver used by the computer.
+ * */
+#define DEFAULT_SOLVER SOLVER_MINIMAX
+
+/**
+ * \brief Default number of solver threads (0 for one per online processor).
+ * */
+#define DEFAULT_SOLVER_THREADS 0
+
+/**
+ * \brief Maximum number of pawns for which a feedback table can be built.
+ * */
+#define MAX_FEEDBACK_TABLE_PAWNS 5
+
+/**
+ * \brief Default maximum number of pawns of the games using a feedback table.
+ * */
+#define DEFAULT_FEEDBACK_TABLE_PAWNS 4
+
 /**
  * Declare the Combination opaque type.
  * */
@@ -154,7 +216,8 @@ ModelMainMenu *create_model_main_menu(void);
 
 /**
  * \fn void destroy_model_main_menu(ModelMainMenu *mmm)
- * \brief Free memory allocated for ModelMainMenu structure.
+ * \brief Free memory allocated for ModelMainMenu structure, once the
+ * scores of its games are saved.
  *
  * \param mmm A valid pointer to ModelMainMenu structure.
  *
@@ -167,6 +230,8 @@ void destroy_model_main_menu(ModelMainMenu *mmm);
 /**
  * \fn ModelMastermind *create_model_mastermind(ModelMainMenu *mmm);
  * \brief Creates ModelMastermind structure with menu values and default values.
+ * The scores are loaded by the first game, then shared by the next ones,
+ * unless the games record no score (see set_save_scores()).
  *
  * \param mmm Pointer to the ModelMainMenu structure containing the main menu settings.
  *
@@ -193,41 +258,72 @@ void destroy_model_mastermind(ModelMastermind *mm);
 
 
 /**
- * \fn SavedScores *load_scores(const char *filePath)
- * \brief Allocates the space for it and saves the scores from the given file
- * if the given file doesn't exist allocates the memory and returns the
- * empty structure
+ * \fn SavedScores *load_scores(const char *filePath, const char *importPath)
+ * \brief Maps the binary score file in memory, then replays over it the
+ * score changes appended to its journal (filePath followed by
+ * SCORES_JOURNAL_SUFFIX) since it was written. Without file, the scores
+ * start empty, or with those of the text file importPath, saved in a new
+ * score file. A score file of a previous version is upgraded. Another file
+ * that is not a score file of this version is moved aside (filePath
+ * followed by ".invalid") and the scores start empty.
+ *
+ * Several processes can share the files: they lock the lock file (filePath
+ * followed by SCORES_LOCK_SUFFIX) to read or append to them, and apply the
+ * changes of the others before saving theirs.
  *
  * \param filePath the file from which de score needs to be read
+ * \param importPath the text score file of the previous versions, or NULL
  *
  * \pre filePath != NULL
- * \post the memory is allocated and the values are read
+ * \post the file is mapped and the journal is open
  *
  * \return A pointer on the created SavedScores structure
  *         NULL if an error was encountered
  */
-SavedScores *load_scores(const char *filePath);
+SavedScores *load_scores(const char *filePath, const char *importPath);
 
 /**
- * \fn int write_scores(SavedScores *scores, const char *filePath)
- * \brief writes in the given file the scores and destroy the score
+ * \fn int write_scores(SavedScores *scores)
+ * \brief Asks the score writer to save the recorded changes now, without
+ * waiting for it. The writer appends them to the journal of the file they
+ * were loaded from and compacts a long journal in a new score file, which
+ * atomically replaces the previous one. Without writer, the changes are
+ * saved before returning.
  *
  * \param scores A pointer on the score structure that needs to be saved in
  * the file
- * \param filePath A string containing the path of the file in which the
- * score should be wrote
  *
- * \pre scores != NULL, filePath != NULL
- * \post The score are written in the file and the structure is freed
+ * \pre scores != NULL
+ * \post The scores are being written in the file.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the file, since the previous call
+ */
+int write_scores(SavedScores *scores);
+
+/**
+ * \fn int record_score(SavedScores *scores, const char *pseudo, unsigned points)
+ * \brief Adds points to the score of a player, added if the player has no
+ * score yet. The change is handed to the score writer, a thread started by
+ * the first change, which saves the changes of a burst in one write.
+ *
+ * \param scores A pointer on the SavedScores structure
+ * \param pseudo The pseudo of the player
+ * \param points The number of points to add
+ *
+ * \pre scores != NULL, pseudo != NULL
+ * \post The score of the player is updated in the mapped file.
  *
  * \return 0 if success
- *         -1 Error manipulating the file
+ *         -1 Error growing the file, scores is then unchanged
  */
-int write_scores(SavedScores *scores, const char *filePath);
+int record_score(SavedScores *scores, const char *pseudo, unsigned points);
 
 /**
  * \fn void destroy_saved_scores(SavedScores *scores)
- * \brief destroy given SavedScores structure
+ * \brief destroy given SavedScores structure, once the score writer saved
+ * the last changes. A writer still busy after a few seconds is left to
+ * finish and free the structure.
  *
  * \param scores pointer on structure ot destroy
  *
@@ -237,10 +333,128 @@ int write_scores(SavedScores *scores, const char *filePath);
 void destroy_saved_scores(SavedScores *scores);
 
 
+/**
+ * \fn size_t get_feedback_table_size(unsigned int nbPawns)
+ * \brief Gives the memory used by the feedback table of a number of pawns.
+ *
+ * The table holds one byte per (proposition, solution) pair, that is
+ * 7^(2 * nbPawns) bytes.
+ *
+ * \param nbPawns The number of pawns.
+ *
+ * \return The size of the table in bytes,
+ *         0 if no table can be built for nbPawns.
+ */
+size_t get_feedback_table_size(unsigned int nbPawns);
+
+
+/**
+ * \fn void destroy_feedback_tables(void)
+ * \brief Frees the feedback tables built by the solvers.
+ *
+ * \pre No game is using a solver.
+ * \post Memory allocated for the feedback tables is freed.
+ */
+void destroy_feedback_tables(void);
+
+
+/**
+ * \fn bool is_feedback_kernel_supported(FEEDBACK_KERNEL kernel)
+ * \brief Tells whether a feedback kernel runs on this compiler and processor.
+ * The solvers use the AVX2 kernel when it is supported, the scalar one
+ * otherwise.
+ *
+ * \param kernel The kernel.
+ *
+ * \pre kernel < NB_FEEDBACK_KERNELS
+ *
+ * \return true if the kernel is supported,
+ *         false otherwise.
+ */
+bool is_feedback_kernel_supported(FEEDBACK_KERNEL kernel);
+
+
+/**
+ * \fn int determine_feedback_keys(FEEDBACK_KERNEL kernel, unsigned int proposition, unsigned int nbPawns, unsigned char *keys)
+ * \brief Determines with a given kernel the feedbacks of a configuration
+ * against every configuration, to check and time the kernels.
+ *
+ * Configurations are indexed in lexicographic order. A feedback is given as
+ * the key nbCorrect * (MAX_NB_PAWNS + 1) + nbMisplaced.
+ *
+ * \param kernel The kernel.
+ * \param proposition The index of the proposition.
+ * \param nbPawns The number of pawns.
+ * \param keys Receives one key per configuration, 7^nbPawns keys.
+ *
+ * \pre kernel < NB_FEEDBACK_KERNELS, 1 <= nbPawns <= MAX_NB_PAWNS,
+ *      proposition < 7^nbPawns, keys != NULL
+ *
+ * \return 0 if success,
+ *         -1 if the kernel is not supported.
+ */
+int determine_feedback_keys(FEEDBACK_KERNEL kernel, unsigned int proposition,
+                            unsigned int nbPawns, unsigned char *keys);
+
+
+/**
+ * \fn int load_opening_book(const char *filePath)
+ * \brief Loads the first and second propositions precomputed for the solvers.
+ *
+ * The solvers look their first two propositions up in the book before
+ * searching them. Must be called before any game starts.
+ *
+ * \param filePath the file from which the book needs to be read
+ *
+ * \pre filePath != NULL
+ * \post The book is loaded, or empty if an error was encountered.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating or parsing the file
+ */
+int load_opening_book(const char *filePath);
+
+
+/**
+ * \fn bool generate_opening_book(ModelMainMenu *mmm, unsigned long long maxWork)
+ * \brief Computes the opening book entries of the selected solver and number
+ * of pawns: the first proposition, and the second one after every feedback.
+ *
+ * \param mmm A pointer on the ModelMainMenu structure holding the settings.
+ * \param maxWork The maximum number of feedbacks computed per proposition.
+ *
+ * \pre mmm != NULL, maxWork > 0, no game is running
+ * \post The entries are set in the book.
+ *
+ * \return true if the entries were computed,
+ *         false if the solver needs no book or memory allocation failed.
+ */
+bool generate_opening_book(ModelMainMenu *mmm, unsigned long long maxWork);
+
+
+/**
+ * \fn int write_opening_book(const char *filePath)
+ * \brief Writes the opening book in the given file.
+ *
+ * \param filePath A string containing the path of the file in which the
+ * book should be wrote
+ *
+ * \pre filePath != NULL
+ * \post The book is written in the file.
+ *
+ * \return 0 if success
+ *         -1 Error manipulating the file
+ */
+int write_opening_book(const char *filePath);
+
+
 /**
  * \fn void generate_random_solution(ModelMastermind *mm)
  * \brief Generates a random solution for the model.
  *
+ * The solutions only depend on the seed of the main menu when the game was
+ * created (see set_seed()).
+ *
  * \param mm a valid pointer to ModelMastermind structure.
  *
  * \pre mm != NULL
@@ -480,6 +694,23 @@ unsigned int get_nb_combinations(ModelMastermind *mm);
 int get_current_index(ModelMastermind *mm);
 
 
+/**
+ * \fn PAWN_COLOR get_pawn_combination(ModelMastermind *mm, unsigned int index, unsigned int pawnIndex)
+ * \brief Gets the pawn color at the specified index in a combination of the
+ * history.
+ *
+ * \param mm A valid pointer to the ModelMastermind structure.
+ * \param index The index of the combination in the history.
+ * \param pawnIndex The index of the pawn in the combination.
+ *
+ * \pre mm != NULL, index < number of combinations, pawnIndex < number of pawns
+ *
+ * \return The pawn color, PAWN_DEFAULT if the combination is not played yet.
+ */
+PAWN_COLOR get_pawn_combination(ModelMastermind *mm, unsigned int index,
+                                unsigned int pawnIndex);
+
+
 /**
  * \fn PAWN_COLOR get_pawn_last_combination(ModelMastermind *mm, unsigned int pawnIndex)
  * \brief Gets the pawn color at the specified index in the last combination.
@@ -524,6 +755,36 @@ unsigned int get_nb_correct_last_combination(ModelMastermind *mm);
 unsigned int get_nb_misplaced_last_combination(ModelMastermind *mm);
 
 
+/**
+ * \fn unsigned int get_nb_correct_combination(ModelMastermind *mm, unsigned int index)
+ * \brief Gets the number of correct pawns in a combination of the history.
+ *
+ * \param mm A valid pointer to the ModelMastermind structure.
+ * \param index The index of the combination in the history.
+ *
+ * \pre mm != NULL, index < number of combinations
+ *
+ * \return The number of correct pawns of the combination, 0 without feedback.
+ */
+unsigned int get_nb_correct_combination(ModelMastermind *mm, unsigned int index);
+
+
+/**
+ * \fn unsigned int get_nb_misplaced_combination(ModelMastermind *mm, unsigned int index)
+ * \brief Gets the number of misplaced pawns in a combination of the history.
+ *
+ * \param mm A valid pointer to the ModelMastermind structure.
+ * \param index The index of the combination in the history.
+ *
+ * \pre mm != NULL, index < number of combinations
+ *
+ * \return The number of misplaced pawns of the combination, 0 without
+ *         feedback.
+ */
+unsigned int get_nb_misplaced_combination(ModelMastermind *mm,
+                                          unsigned int index);
+
+
 /**
  * \fn FEEDBACK_COLOR get_feedback_pawn(ModelMastermind *mm, unsigned int index)
  * \brief Gets the feedback pawn color at the specified index.
@@ -548,7 +809,8 @@ FEEDBACK_COLOR get_feedback_pawn(ModelMastermind *mm, unsigned int index);
  * \pre mm != NULL
  * \post Scores are returned
  *
- * \return The saved scores in the ModelMastermind.
+ * \return The saved scores in the ModelMastermind,
+ *         NULL if the game records no score.
  */
 SavedScores *get_saved_scores(ModelMastermind *mm);
 
@@ -561,22 +823,38 @@ SavedScores *get_saved_scores(ModelMastermind *mm);
  * \pre mm != NULL
  * \post The length of the saved score in The mastermind is returned
  *
- * \return The length field in the save field of ModelMastermind
+ * \return The length field in the save field of ModelMastermind,
+ *         0 if the game records no score
  */
 unsigned get_saved_scores_length(ModelMastermind *mm);
 
 /**
- * \fn char **get_scores_strings(SavedScores *scores)
+ * \fn char **get_scores_strings(SavedScores *scores, unsigned *length)
  * \brief Returns the strings that needs to be in the labels of the scores
  *
  * \param scores A pointer on the SavedScores structure
+ * \param length Receives the number of strings, at most MAX_SCORE_DISPLAYED
  *
- * \pre scores != NULL
+ * \pre scores != NULL, length != NULL
  * \post the array of string is returned
  *
  * \return An array of strings with the ranking pseudo and score
  */
-char **get_scores_strings(SavedScores *scores);
+char **get_scores_strings(SavedScores *scores, unsigned *length);
+
+/**
+ * \fn unsigned long get_scores_changes(SavedScores *scores)
+ * \brief Counts the changes of the scores since they were loaded, including
+ * those saved by other processes. The scores changed between two calls if
+ * the counts differ.
+ *
+ * \param scores A pointer on the SavedScores structure
+ *
+ * \pre scores != NULL
+ *
+ * \return The number of changes of the scores
+ */
+unsigned long get_scores_changes(SavedScores *scores);
 
 /**
  * \fn void free_scores_strings(char **strings, unsigned length)
@@ -629,6 +907,75 @@ void set_role(ModelMainMenu *mmm, ROLE role);
 void set_nb_pawns_slider(ModelMainMenu *mmm, unsigned int nbPawns);
 
 
+/**
+ * \fn void set_seed(ModelMainMenu *mmm, unsigned int seed)
+ * \brief sets the seed of the random solution of the next game. Each game
+ * created then increments it.
+ *
+ * \param mmm A pointer on the ModelMainMenu structure
+ * \param seed The seed, the current time by default.
+ *
+ * \pre mmm != NULL
+ * \post the seed is set.
+ */
+void set_seed(ModelMainMenu *mmm, unsigned int seed);
+
+
+/**
+ * \fn void set_save_scores(ModelMainMenu *mmm, bool saveScores)
+ * \brief sets whether the next games load and record the scores. Headless
+ * games, such as simulations, record none so that they leave the score
+ * file untouched.
+ *
+ * \param mmm A pointer on the ModelMainMenu structure
+ * \param saveScores Whether the games record the scores, true by default.
+ *
+ * \pre mmm != NULL
+ * \post the score mode is set.
+ */
+void set_save_scores(ModelMainMenu *mmm, bool saveScores);
+
+
+/**
+ * \fn void set_solver(ModelMainMenu *mmm, SOLVER solver)
+ * \brief sets the solver the computer uses in proposer mode.
+ *
+ * \param mmm A pointer on the ModelMainMenu structure
+ * \param solver The solver strategy.
+ *
+ * \pre mmm != NULL, solver < NB_SOLVERS
+ * \post the solver is set.
+ */
+void set_solver(ModelMainMenu *mmm, SOLVER solver);
+
+
+/**
+ * \fn void set_solver_threads(ModelMainMenu *mmm, unsigned int nbThreads)
+ * \brief sets the number of threads the solvers use to score propositions.
+ *
+ * \param mmm A pointer on the ModelMainMenu structure
+ * \param nbThreads The number of threads, 0 for one per online processor.
+ *
+ * \pre mmm != NULL
+ * \post the number of solver threads is set.
+ */
+void set_solver_threads(ModelMainMenu *mmm, unsigned int nbThreads);
+
+
+/**
+ * \fn void set_feedback_table_max_pawns(ModelMainMenu *mmm, unsigned int maxPawns)
+ * \brief sets the maximum number of pawns of the games whose solver uses a
+ * precomputed feedback table (see get_feedback_table_size()).
+ *
+ * \param mmm A pointer on the ModelMainMenu structure
+ * \param maxPawns The maximum number of pawns, 0 to never use a table.
+ *
+ * \pre mmm != NULL
+ * \post the maximum number of pawns is set.
+ */
+void set_feedback_table_max_pawns(ModelMainMenu *mmm, unsigned int maxPawns);
+
+
 /**
  * \fn void set_pseudo(ModelMainMenu *mmm, char *pseudo)
  * \brief sets the player pseudo in the main menu model.
@@ -693,6 +1040,22 @@ void set_feedback_pawn(ModelMastermind *mm, unsigned int index);
 void set_proposition_as_solution(ModelMastermind *mm);
 
 
+/**
+ * \fn void set_last_combination_feedback(ModelMastermind *mm, unsigned int nbCorrect, unsigned int nbMisplaced)
+ * \brief Sets the feedback of the last combination in the history and keeps
+ * the configurations consistent with it.
+ *
+ * \param mm A pointer on the ModelMastermind structure
+ * \param nbCorrect The number of correctly placed pawns.
+ * \param nbMisplaced The number of misplaced pawns.
+ *
+ * \pre mm != NULL, nbCorrect + nbMisplaced <= number of pawns
+ * \post the feedback of the last combination is set.
+ */
+void set_last_combination_feedback(ModelMastermind *mm, unsigned int nbCorrect,
+                                   unsigned int nbMisplaced);
+
+
 /**
  * \fn void set_valid_solution_true(ModelMastermind *mm)
  * \brief Sets the solution to valid state.
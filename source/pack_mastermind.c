@@ -0,0 +1,187 @@
+/**
+ * \file pack_mastermind.c
+ * \brief Image packer of mastermind game
+ * \authors Fraiponts Thomas, Schins Martin
+ * \version 0.1
+ * \date 06/05/2024
+ *
+ * INFO0030 : Projet de programmation 4, Mastermind.
+ * Decodes the images of the game and writes their RGBA pixels in a C file
+ * compiled in the game (see images_mastermind.h). Each image is reduced to
+ * fit in a square of the last size given before it, keeping its aspect.
+ *
+ * Usage: mastermind-pack -o filePath [-s maxSize] image...
+ *
+ * */
+
+#include <gtk-2.0/gtk/gtk.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "images_mastermind.h"
+
+/**
+ * \brief Default maximum width and height of an image, in pixels.
+ */
+#define DEFAULT_MAX_SIZE 128
+
+/**
+ * \brief Number of bytes written per line of the C file.
+ */
+#define BYTES_PER_LINE 16
+
+
+/**
+ * \fn static bool write_image(FILE *pFile, unsigned int index, const char *path, unsigned int maxSize, unsigned int *width, unsigned int *height)
+ * \brief Decodes an image and writes its pixels in a C array.
+ *
+ * \param pFile The C file.
+ * \param index The index of the image, naming its array.
+ * \param path The path of the image.
+ * \param maxSize The maximum width and height of the image.
+ * \param width Receives the width of the image written.
+ * \param height Receives the height of the image written.
+ *
+ * \pre pFile != NULL, path != NULL, width != NULL, height != NULL
+ *
+ * \return true if the image is written,
+ *         false if it could not be decoded.
+ */
+static bool write_image(FILE *pFile, unsigned int index, const char *path,
+                        unsigned int maxSize, unsigned int *width,
+                        unsigned int *height);
+
+
+static bool write_image(FILE *pFile, unsigned int index, const char *path,
+                        unsigned int maxSize, unsigned int *width,
+                        unsigned int *height) {
+   GError *error = NULL;
+   GdkPixbuf *pb = gdk_pixbuf_new_from_file_at_scale(path, maxSize, maxSize,
+                                                     TRUE, &error);
+   if(pb == NULL){
+      fprintf(stderr, "Failed to decode %s: %s\n", path,
+              (error != NULL) ? error->message : "unknown error");
+      if(error != NULL)
+         g_error_free(error);
+      return false;
+   }
+
+   *width = gdk_pixbuf_get_width(pb);
+   *height = gdk_pixbuf_get_height(pb);
+   unsigned int nbChannels = gdk_pixbuf_get_n_channels(pb);
+   unsigned int rowstride = gdk_pixbuf_get_rowstride(pb);
+   const guchar *pixels = gdk_pixbuf_get_pixels(pb);
+   unsigned long nbBytes = 0;
+
+   fprintf(pFile, "/* %s */\nstatic const uint8_t PIXELS_%u[] = {", path,
+           index);
+
+   // Images without alpha channel are written opaque.
+   for(unsigned int y = 0; y < *height; y++){
+      const guchar *row = pixels + (size_t) y * rowstride;
+
+      for(unsigned int x = 0; x < *width; x++){
+         for(unsigned int c = 0; c < IMAGE_ASSET_CHANNELS; c++){
+            unsigned int value = (c < nbChannels) ? row[x * nbChannels + c]
+                                                  : 255;
+            if(nbBytes++ % BYTES_PER_LINE == 0)
+               fprintf(pFile, "\n   ");
+            fprintf(pFile, "%u,", value);
+         }
+      }
+   }
+
+   fprintf(pFile, "\n};\n\n");
+   g_object_unref(pb);
+
+   return true;
+}
+
+
+int main(int argc, char **argv) {
+
+#if !GLIB_CHECK_VERSION(2, 36, 0)
+   g_type_init();
+#endif
+
+   const char *filePath = NULL;
+   unsigned int nbPaths = 0;
+   bool validArguments = true;
+
+   // The first pass only checks the arguments, the paths are C strings.
+   for(int i = 1; i < argc && validArguments; i++){
+      if(!strcmp(argv[i], "-o") && i + 1 < argc)
+         filePath = argv[++i];
+      else if(!strcmp(argv[i], "-s") && i + 1 < argc)
+         i++;
+      else if(argv[i][0] == '-' || strpbrk(argv[i], "\"\\") != NULL)
+         validArguments = false;
+      else
+         nbPaths++;
+   }
+
+   // An empty array of images is not valid C.
+   if(!validArguments || filePath == NULL || nbPaths == 0){
+      fprintf(stderr, "Usage: %s -o filePath [-s maxSize] image...\n",
+              argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   unsigned int *widths = malloc(nbPaths * sizeof(unsigned int));
+   unsigned int *heights = malloc(nbPaths * sizeof(unsigned int));
+   const char **paths = malloc(nbPaths * sizeof(const char *));
+   FILE *pFile = fopen(filePath, "w");
+   if(widths == NULL || heights == NULL || paths == NULL || pFile == NULL){
+      fprintf(stderr, "Failed to create %s\n", filePath);
+      if(pFile != NULL)
+         fclose(pFile);
+      free(widths);
+      free(heights);
+      free(paths);
+      return EXIT_FAILURE;
+   }
+
+   fprintf(pFile, "/* Generated by mastermind-pack, do not edit. */\n\n"
+                  "#include \"images_mastermind.h\"\n\n");
+
+   unsigned int maxSize = DEFAULT_MAX_SIZE;
+   unsigned int nbImages = 0;
+   bool success = true;
+
+   for(int i = 1; i < argc && success; i++){
+      if(!strcmp(argv[i], "-o"))
+         i++;
+      else if(!strcmp(argv[i], "-s"))
+         maxSize = strtoul(argv[++i], NULL, 10);
+      else{
+         paths[nbImages] = argv[i];
+         success = maxSize > 0 &&
+                   write_image(pFile, nbImages, argv[i], maxSize,
+                               &widths[nbImages], &heights[nbImages]);
+         nbImages++;
+      }
+   }
+
+   if(success){
+      fprintf(pFile, "const ImageAsset IMAGE_ASSETS[] = {\n");
+      for(unsigned int i = 0; i < nbImages; i++)
+         fprintf(pFile, "   {\"%s\", %u, %u, PIXELS_%u},\n", paths[i],
+                 widths[i], heights[i], i);
+      fprintf(pFile, "};\n\nconst unsigned int NB_IMAGE_ASSETS = %u;\n",
+              nbImages);
+   }
+
+   free(widths);
+   free(heights);
+   free(paths);
+
+   if(fclose(pFile) != 0 || !success){
+      fprintf(stderr, "Failed to write %s\n", filePath);
+      remove(filePath);
+      return EXIT_FAILURE;
+   }
+
+   return EXIT_SUCCESS;
+}
@@ -0,0 +1,329 @@
+/**
+ * \file sim_mastermind.c
+ * \brief Headless game simulator of mastermind game
+ * \authors Fraiponts Thomas, Schins Martin
+ * \version 0.1
+ * \date 04/05/2024
+ *
+ * INFO0030 : Projet de programmation 4, Mastermind.
+ * Plays games against random solutions with a solver, without GTK, and
+ * reports the number of propositions needed and the throughput.
+ *
+ * Usage: mastermind-sim [-n nbGames] [-p nbPawns] [-s solver] [-S seed]
+ *                       [-t nbThreads] [-b bookPath]
+ *
+ * */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "model_mastermind.h"
+
+/**
+ * \brief Default number of games played.
+ */
+#define DEFAULT_NB_GAMES 1000
+
+/**
+ * \brief Names of the solvers on the command line, by SOLVER value.
+ */
+static const char *SOLVER_NAMES[NB_SOLVERS] = {
+   "first", "minimax", "entropy", "expected"
+};
+
+/**
+ * \brief Settings of a simulation and games shared between its threads.
+ */
+typedef struct {
+   unsigned int nbGames;      /*!< Number of games to play */
+   unsigned int nbPawns;      /*!< Number of pawns of the games */
+   SOLVER solver;             /*!< Solver finding the propositions */
+   unsigned int seed;         /*!< Seed of the first game */
+   pthread_mutex_t lock;      /*!< Lock of nextGame */
+   unsigned int nextGame;     /*!< Index of the next game to play */
+} Simulation;
+
+/**
+ * \brief Thread playing games of a Simulation.
+ */
+typedef struct {
+   Simulation *simulation;                   /*!< Shared simulation */
+   unsigned int nbWon[NB_COMBINATIONS + 1];  /*!< Games won, by number of propositions */
+   unsigned int nbLost;                      /*!< Games not found in NB_COMBINATIONS propositions */
+   bool failed;                              /*!< Whether a memory allocation failed */
+} SimulationWorker;
+
+
+/**
+ * \fn static int play_game(ModelMainMenu *mmm)
+ * \brief Plays a game of the computer against a random solution.
+ *
+ * \param mmm A pointer on the ModelMainMenu holding the game settings.
+ *
+ * \pre mmm != NULL
+ *
+ * \return The number of propositions needed to find the solution,
+ *         0 if it was not found,
+ *         -1 if memory allocation failed.
+ */
+static int play_game(ModelMainMenu *mmm);
+
+
+/**
+ * \fn static void *run_simulation_worker(void *data)
+ * \brief Plays games of the simulation until all of them are played.
+ *
+ * \param data A pointer on the SimulationWorker.
+ *
+ * \pre data != NULL
+ *
+ * \return NULL
+ */
+static void *run_simulation_worker(void *data);
+
+
+/**
+ * \fn static bool parse_solver(const char *name, SOLVER *solver)
+ * \brief Reads a solver from its name or its number.
+ *
+ * \param name The name of the solver.
+ * \param solver Receives the solver.
+ *
+ * \pre name != NULL, solver != NULL
+ *
+ * \return true if the solver exists,
+ *         false otherwise.
+ */
+static bool parse_solver(const char *name, SOLVER *solver);
+
+
+static int play_game(ModelMainMenu *mmm) {
+   ModelMastermind *mm = create_model_mastermind(mmm);
+   if(mm == NULL)
+      return -1;
+
+   generate_random_solution(mm);
+   set_valid_solution_true(mm);
+
+   find_next_proposition(mm);
+   set_proposition_in_history(mm);
+
+   int nbPropositions = 0;
+   bool found = false;
+
+   while(get_in_game(mm)){
+      nbPropositions++;
+
+      determine_feedback_proposition(mm, get_proposition(mm), get_solution(mm));
+      set_proposition_in_history(mm);
+
+      unsigned int nbCorrect = get_nb_correct_last_combination(mm);
+      found = nbCorrect == get_nb_pawns(mm);
+      set_last_combination_feedback(mm, nbCorrect,
+                                    get_nb_misplaced_last_combination(mm));
+      verify_end_game(mm);
+      update_current_combination_index(mm);
+
+      if(get_in_game(mm)){
+         find_next_proposition(mm);
+         set_proposition_in_history(mm);
+      }
+   }
+
+   destroy_model_mastermind(mm);
+   return found ? nbPropositions : 0;
+}
+
+
+static void *run_simulation_worker(void *data) {
+   SimulationWorker *worker = (SimulationWorker *) data;
+   Simulation *simulation = worker->simulation;
+
+   ModelMainMenu *mmm = create_model_main_menu();
+   if(mmm == NULL){
+      worker->failed = true;
+      return NULL;
+   }
+
+   set_role(mmm, PROPOSER);
+   set_save_scores(mmm, false);
+   set_nb_pawns_slider(mmm, simulation->nbPawns);
+   set_solver(mmm, simulation->solver);
+   // Games are spread over the threads, each solver runs on its own.
+   set_solver_threads(mmm, 1);
+
+   while(!worker->failed){
+      pthread_mutex_lock(&simulation->lock);
+      unsigned int game = simulation->nextGame;
+      if(game < simulation->nbGames)
+         simulation->nextGame++;
+      pthread_mutex_unlock(&simulation->lock);
+
+      if(game >= simulation->nbGames)
+         break;
+
+      // The solution of a game does not depend on the thread playing it.
+      set_seed(mmm, simulation->seed + game);
+
+      int nbPropositions = play_game(mmm);
+      if(nbPropositions < 0)
+         worker->failed = true;
+      else if(nbPropositions == 0)
+         worker->nbLost++;
+      else
+         worker->nbWon[nbPropositions]++;
+   }
+
+   destroy_model_main_menu(mmm);
+   return NULL;
+}
+
+
+static bool parse_solver(const char *name, SOLVER *solver) {
+   for(unsigned int i = 0; i < NB_SOLVERS; i++){
+      if(!strcmp(name, SOLVER_NAMES[i])){
+         *solver = i;
+         return true;
+      }
+   }
+
+   char *end;
+   unsigned long value = strtoul(name, &end, 10);
+   if(*name == '\0' || *end != '\0' || value >= NB_SOLVERS)
+      return false;
+
+   *solver = value;
+   return true;
+}
+
+
+int main(int argc, char **argv) {
+
+   Simulation simulation;
+   simulation.nbGames = DEFAULT_NB_GAMES;
+   simulation.nbPawns = DEFAULT_NB_PAWNS;
+   simulation.solver = DEFAULT_SOLVER;
+   simulation.seed = 0;
+   simulation.nextGame = 0;
+
+   unsigned int nbThreads = 1;
+   const char *bookPath = OPENING_BOOK_PATH;
+   bool validArguments = true;
+
+   for(int i = 1; i < argc && validArguments; i++){
+      if(i + 1 == argc)
+         validArguments = false;
+      else if(!strcmp(argv[i], "-n"))
+         simulation.nbGames = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-p"))
+         simulation.nbPawns = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-s"))
+         validArguments = parse_solver(argv[++i], &simulation.solver);
+      else if(!strcmp(argv[i], "-S"))
+         simulation.seed = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-t"))
+         nbThreads = strtoul(argv[++i], NULL, 10);
+      else if(!strcmp(argv[i], "-b"))
+         bookPath = argv[++i];
+      else
+         validArguments = false;
+   }
+
+   if(!validArguments || simulation.nbPawns < MIN_NB_PAWNS ||
+      simulation.nbPawns > MAX_NB_PAWNS || nbThreads == 0){
+      fprintf(stderr, "Usage: %s [-n nbGames] [-p nbPawns] [-s solver] "
+                      "[-S seed] [-t nbThreads] [-b bookPath]\n"
+                      "Solvers: first, minimax, entropy, expected.\n"
+                      "Pawns: %d to %d.\n", argv[0], MIN_NB_PAWNS,
+              MAX_NB_PAWNS);
+      return EXIT_FAILURE;
+   }
+
+   // Without a book, the solvers search their first propositions.
+   load_opening_book(bookPath);
+
+   SimulationWorker *workers = calloc(nbThreads, sizeof(SimulationWorker));
+   pthread_t *threads = malloc(nbThreads * sizeof(pthread_t));
+   if(workers == NULL || threads == NULL){
+      free(workers);
+      free(threads);
+      return EXIT_FAILURE;
+   }
+
+   pthread_mutex_init(&simulation.lock, NULL);
+
+   struct timespec start, end;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+
+   for(unsigned int i = 0; i < nbThreads; i++)
+      workers[i].simulation = &simulation;
+
+   // The threads started share the games of those that failed to start.
+   unsigned int nbStarted = 0;
+   while(nbStarted < nbThreads &&
+         pthread_create(&threads[nbStarted], NULL, run_simulation_worker,
+                        &workers[nbStarted]) == 0)
+      nbStarted++;
+
+   for(unsigned int i = 0; i < nbStarted; i++)
+      pthread_join(threads[i], NULL);
+
+   unsigned int nbWorkers = nbStarted;
+   if(nbWorkers == 0){
+      run_simulation_worker(&workers[0]);
+      nbWorkers = 1;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   pthread_mutex_destroy(&simulation.lock);
+
+   unsigned int nbWon[NB_COMBINATIONS + 1] = {0};
+   unsigned int nbLost = 0;
+   bool failed = false;
+
+   for(unsigned int i = 0; i < nbWorkers; i++){
+      for(unsigned int j = 0; j <= NB_COMBINATIONS; j++)
+         nbWon[j] += workers[i].nbWon[j];
+      nbLost += workers[i].nbLost;
+      failed |= workers[i].failed;
+   }
+
+   free(workers);
+   free(threads);
+   destroy_feedback_tables();
+
+   if(failed){
+      fprintf(stderr, "Memory allocation failed\n");
+      return EXIT_FAILURE;
+   }
+
+   double seconds = (end.tv_sec - start.tv_sec) +
+                    (end.tv_nsec - start.tv_nsec) / 1e9;
+   unsigned long long nbPropositions = 0;
+   unsigned int nbPlayed = nbLost;
+
+   printf("solver: %s, pawns: %u, games: %u, seed: %u, threads: %u\n",
+          SOLVER_NAMES[simulation.solver], simulation.nbPawns,
+          simulation.nbGames, simulation.seed, nbWorkers);
+   printf("propositions games\n");
+   for(unsigned int i = 1; i <= NB_COMBINATIONS; i++){
+      printf("%12u %u\n", i, nbWon[i]);
+      nbPropositions += (unsigned long long) i * nbWon[i];
+      nbPlayed += nbWon[i];
+   }
+   printf("%12s %u\n", "lost", nbLost);
+
+   if(nbPlayed > nbLost)
+      printf("average: %.4f propositions per won game\n",
+             (double) nbPropositions / (nbPlayed - nbLost));
+   printf("throughput: %.1f games/s (%.3f s)\n",
+          (seconds > 0) ? nbPlayed / seconds : 0.0, seconds);
+
+   return EXIT_SUCCESS;
+}
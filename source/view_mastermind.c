@@ -13,8 +13,11 @@
 #include <gtk-2.0/gtk/gtk.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "view_mastermind.h"
+#include "images_mastermind.h"
 
 
 struct view_main_menu_t {
@@ -36,8 +39,6 @@ struct view_mastermind_t {
    unsigned int bigButtonSize;                    /*!< Big button size */
    unsigned int colorButtonSize;                  /*!< Color button size */
    unsigned int propositionButtonSize;            /*!< Proposition button size */
-   GdkPixbuf *winImage;                           /*!< Win image pixbuf */
-   GdkPixbuf *looseImage;                         /*!< Lose image pixbuf */
    GtkWidget *endGameWindow;                      /*!< End game window widget */
    GtkWidget *windowAbouts;                       /*!< Abouts window widget */
    GtkWidget *windowScore;                        /*!< Score window widget */
@@ -45,23 +46,199 @@ struct view_mastermind_t {
    GtkWidget *scoreMainVBox;                      /*!< Main vertical box for score window */
    GtkWidget *aboutsLabel;                        /*!< Label for abouts window */
    GtkWidget *scoresTitleLabel;                   /*!< Title label for score window */
-   GtkWidget *scoresLabels[MAX_SCORE_DISPLAYED];  /*!< Scores labels */
+   GtkWidget *scoresLabels[MAX_SCORE_DISPLAYED];  /*!< Scores labels, hidden without score */
+   unsigned long scoresChanges;                   /*!< Changes of the scores when the labels were updated */
    GtkWidget *window;                             /*!< Main window widget */
    GtkWidget *mainVBox;                           /*!< Main vertical box */
-   GtkWidget *historyTable;                       /*!< Table for displaying history */
+   GtkWidget *historyBoard;                       /*!< Drawing area of the history */
+   uint8_t boardCells[NB_COMBINATIONS][2 * MAX_NB_PAWNS]; /*!< Color shown by each cell of the history board */
+   GdkRectangle dirtyArea;                        /*!< Cells of the history board changed since the last redraw, empty if its width is 0 */
    GtkWidget *feedbackZoneHBox;                   /*!< Horizontal box for feedback zone */
    GtkWidget *propositionHBox;                    /*!< Horizontal box for proposition */
    GtkWidget *propositionControlHBox;             /*!< Horizontal box for proposition control */
    GtkWidget *colorSelectionHBox;                 /*!< Horizontal box for color selection */
    GtkWidget *scoreHBox;                          /*!< Horizontal box for display score */
-   GdkPixbuf **colorImagePixbufs;                 /*!< Array of color image pixbufs */
-   GdkPixbuf **feedbackImagePixbufs;              /*!< Array of feedback image pixbufs */
-   GtkWidget ***historyCombinations;              /*!< 2D array for history combinations */
-   GtkWidget ***historyFeedbacks;                 /*!< 2D array for history feedbacks */
+   GdkPixbuf *buttonAtlas;                        /*!< Pixels of every pawn image at every button size */
+   GdkPixbuf *colorButtonPixbufs[NB_BUTTON_SIZES][NB_PAWN_COLORS];  /*!< Color pixbufs scaled for each button size, in buttonAtlas */
+   GdkPixbuf *feedbackButtonPixbufs[NB_BUTTON_SIZES][NB_FB_COLORS]; /*!< Feedback pixbufs scaled for each button size, in buttonAtlas */
    GtkWidget *scoreLabel;                        /*!< Score label */
 };
 
 
+/**
+ * \brief Images decoded once per process and shared by the games.
+ */
+typedef struct {
+   bool loaded;                               /*!< Whether the images are loaded */
+   GdkPixbuf *winImage;                       /*!< Win image pixbuf */
+   GdkPixbuf *looseImage;                     /*!< Lose image pixbuf */
+   GdkPixbuf *colorImages[NB_PAWN_COLORS];    /*!< Color image pixbufs, by PAWN_COLOR */
+   GdkPixbuf *feedbackImages[NB_FB_COLORS];   /*!< Feedback image pixbufs, by FEEDBACK_COLOR */
+} ViewAssets;
+
+
+/**
+ * \brief Win image path
+ */
+static const char *WIN_FILE_NAME = "images/win.png";
+
+/**
+ * \brief Lose image path
+ */
+static const char *LOOSE_FILE_NAME = "images/loose.png";
+
+/**
+ * \brief Color image paths, by PAWN_COLOR
+ */
+static const char *COLOR_IMAGE_FILENAMES[NB_PAWN_COLORS] = {
+   "images/blue.png",
+   "images/cyan.png",
+   "images/green.png",
+   "images/orange.png",
+   "images/purple.png",
+   "images/red.png",
+   "images/yellow.png",
+   "images/default.png"
+};
+
+/**
+ * \brief Feedback image paths, by FEEDBACK_COLOR
+ */
+static const char *FEEDBACK_IMAGE_FILENAMES[NB_FB_COLORS] = {
+   "images/black.png",
+   "images/white.png",
+   "images/no_feedback.png"
+};
+
+/**
+ * \brief Images of the games, loaded by the first one (see load_view_assets()).
+ * GTK is only used by the main thread, which is the only one to access them.
+ */
+static ViewAssets assets;
+
+/**
+ * \brief Space between the cells of the history board, in pixels
+ */
+#define BOARD_SPACING 4
+
+
+/**
+ * \fn static GdkPixbuf *create_asset_pixbuf(const char *path)
+ * \brief Creates a pixbuf over the pixels of an image embedded in the game,
+ * without copying them.
+ *
+ * \param path The path of the image packed by mastermind-pack.
+ *
+ * \pre path != NULL
+ *
+ * \return A pointer on the new pixbuf,
+ *         NULL if the image is not embedded or memory allocation failed
+ */
+static GdkPixbuf *create_asset_pixbuf(const char *path);
+
+
+/**
+ * \fn static int load_view_assets(void)
+ * \brief Loads the images of the games, unless they are already loaded.
+ *
+ * \post The images are loaded, or none of them if an error was encountered
+ *
+ * \return 0 if success
+ *         -1 if an image could not be loaded
+ */
+static int load_view_assets(void);
+
+
+/**
+ * \fn static int create_button_atlas(ViewMastermind *vm)
+ * \brief Scales every color and feedback pixbuf to every button size once,
+ * in a single atlas, so that changing the image of a button does not
+ * resample it.
+ *
+ * The atlas has a column per button size, holding the color images then the
+ * feedback images. The scaled pixbufs are sub-pixbufs of the atlas, sharing
+ * its pixels.
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ *
+ * \pre vm != NULL, the images are loaded
+ * \post The atlas and scaled pixbufs are filled, or released if an error
+ * was encountered
+ *
+ * \return 0 if success
+ *         -1 if memory allocation failed
+ */
+static int create_button_atlas(ViewMastermind *vm);
+
+
+/**
+ * \fn static GdkPixbuf *add_atlas_sprite(GdkPixbuf *atlas, GdkPixbuf *image, unsigned int x, unsigned int y, unsigned int size)
+ * \brief Draws an image scaled to a square in the atlas.
+ *
+ * \param atlas The atlas.
+ * \param image The image.
+ * \param x The abscissa of the square in the atlas.
+ * \param y The ordinate of the square in the atlas.
+ * \param size The side of the square.
+ *
+ * \pre atlas != NULL, image != NULL, the square is in the atlas
+ *
+ * \return A pointer on the sub-pixbuf of the square,
+ *         NULL if memory allocation failed
+ */
+static GdkPixbuf *add_atlas_sprite(GdkPixbuf *atlas, GdkPixbuf *image,
+                                   unsigned int x, unsigned int y,
+                                   unsigned int size);
+
+
+/**
+ * \fn static void unref_button_pixbufs(ViewMastermind *vm)
+ * \brief Releases the scaled pixbufs of the buttons and their atlas.
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ *
+ * \pre vm != NULL
+ * \post The atlas and scaled pixbufs are NULL
+ */
+static void unref_button_pixbufs(ViewMastermind *vm);
+
+
+/**
+ * \fn static void get_board_cell(ViewMastermind *vm, unsigned int row, unsigned int column, GdkRectangle *cell)
+ * \brief Gets the area of a cell of the history board.
+ *
+ * A row holds the pawns of a combination in its first get_nb_pawns()
+ * columns, then its feedback pegs, centered vertically.
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ * \param row The index of the combination.
+ * \param column The index of the cell in the row.
+ * \param cell Receives the area of the cell, in board coordinates.
+ *
+ * \pre vm != NULL, row < get_nb_combinations(), column < 2 * get_nb_pawns(),
+ * cell != NULL
+ */
+static void get_board_cell(ViewMastermind *vm, unsigned int row,
+                           unsigned int column, GdkRectangle *cell);
+
+
+/**
+ * \fn static void set_board_cell(ViewMastermind *vm, unsigned int row, unsigned int column, uint8_t color)
+ * \brief Sets the color shown by a cell of the history board, adding the
+ * cell to the area to redraw if its color changes.
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ * \param row The index of the combination.
+ * \param column The index of the cell in the row.
+ * \param color The PAWN_COLOR of a pawn, or the FEEDBACK_COLOR of a peg.
+ *
+ * \pre vm != NULL, row < get_nb_combinations(), column < 2 * get_nb_pawns()
+ * \post The cell will be redrawn by redraw_history_board() if it changed
+ */
+static void set_board_cell(ViewMastermind *vm, unsigned int row,
+                           unsigned int column, uint8_t color);
+
+
 ViewMainMenu *create_view_main_menu(ModelMainMenu *mmm) {
    assert(mmm != NULL);
 
@@ -160,16 +337,7 @@ ViewMastermind *create_view_mastermind(ModelMastermind *mm) {
                          (NB_PAWN_COLORS - 1);
    vm->propositionButtonSize = vm->bigButtonSize + vm->smallButtonSize;
 
-   const char *WIN_FILE_NAME = "./images/win.png";
-   vm->winImage = gdk_pixbuf_new_from_file(WIN_FILE_NAME, NULL);
-   if(vm->winImage == NULL){
-      free(vm);
-      return NULL;
-   }
-
-   const char *LOOSE_FILE_NAME = "./images/loose.png";
-   vm->looseImage = gdk_pixbuf_new_from_file(LOOSE_FILE_NAME, NULL);
-   if(vm->looseImage == NULL){
+   if(load_view_assets() != 0){
       free(vm);
       return NULL;
    }
@@ -220,20 +388,18 @@ ViewMastermind *create_view_mastermind(ModelMastermind *mm) {
       return NULL;
    }
 
-   char **SCORES_LABELS = get_scores_strings(get_saved_scores(vm->mm));
-   unsigned size = (get_saved_scores_length(vm->mm) < MAX_SCORE_DISPLAYED)
-                   ? get_saved_scores_length(vm->mm) : MAX_SCORE_DISPLAYED;
-
-   for(unsigned i = 0; i < size; i++){
-      vm->scoresLabels[i] = gtk_label_new(SCORES_LABELS[i]);
+   // Every label is created, the scores can change during the game.
+   for(unsigned i = 0; i < MAX_SCORE_DISPLAYED; i++){
+      vm->scoresLabels[i] = gtk_label_new(NULL);
       if(vm->scoresLabels[i] == NULL){
-         free_scores_strings(SCORES_LABELS, size);
          free(vm);
          return NULL;
       }
+      gtk_widget_set_no_show_all(vm->scoresLabels[i], TRUE);
    }
 
-   free_scores_strings(SCORES_LABELS, size);
+   vm->scoresChanges = get_scores_changes(get_saved_scores(vm->mm)) - 1;
+   update_mastermind_scores_labels(vm);
 
    vm->window = create_window(MASTERMIND_WINDOW_LABEL, -1, -1);
    if(vm->window == NULL){
@@ -247,11 +413,25 @@ ViewMastermind *create_view_mastermind(ModelMastermind *mm) {
       return NULL;
    }
 
-   vm->historyTable = gtk_table_new(nbCombi, 2 * nbPawns, FALSE);
-   if(vm->historyTable == NULL){
+   // A single widget draws the whole history, whatever its size.
+   vm->historyBoard = gtk_drawing_area_new();
+   if(vm->historyBoard == NULL){
       free(vm);
       return NULL;
    }
+   gtk_widget_set_size_request(vm->historyBoard,
+                               nbPawns * (vm->bigButtonSize +
+                                          vm->smallButtonSize +
+                                          2 * BOARD_SPACING),
+                               nbCombi * (vm->bigButtonSize + BOARD_SPACING));
+
+   for(unsigned int i = 0; i < nbCombi; i++){
+      for(unsigned int j = 0; j < nbPawns; j++){
+         vm->boardCells[i][j] = PAWN_DEFAULT;
+         vm->boardCells[i][nbPawns + j] = FB_DEFAULT;
+      }
+   }
+   vm->dirtyArea.width = 0;
 
    vm->feedbackZoneHBox = gtk_hbox_new(FALSE, 0);
    if(vm->feedbackZoneHBox == NULL){
@@ -290,207 +470,260 @@ ViewMastermind *create_view_mastermind(ModelMastermind *mm) {
       return NULL;
    }
 
-   const char *COLOR_IMAGE_FILENAMES[] = {"./images/blue.png",
-                                          "./images/cyan.png",
-                                          "./images/green.png",
-                                          "./images/orange.png",
-                                          "./images/purple.png",
-                                          "./images/red.png",
-                                          "./images/yellow.png",
-                                          "./images/default.png",};
-
-   const char *FEEDBACK_IMAGE_FILENAMES[] = {"./images/black.png",
-                                             "./images/white.png",
-                                             "./images/no_feedback.png"};
-
-   vm->colorImagePixbufs = malloc(NB_PAWN_COLORS * sizeof(GdkPixbuf * ));
-   if(vm->colorImagePixbufs == NULL){
+   if(create_button_atlas(vm) != 0){
       free(vm);
       return NULL;
    }
 
-   for(unsigned int i = 0; i < NB_PAWN_COLORS; i++){
-      vm->colorImagePixbufs[i] = gdk_pixbuf_new_from_file(
-              COLOR_IMAGE_FILENAMES[i], NULL);
-      if(vm->colorImagePixbufs[i] == NULL){
-         free(vm->colorImagePixbufs);
-         free(vm);
-         return NULL;
-      }
-   }
+   return vm;
+}
+
+
+void destroy_view_mastermind(ViewMastermind *vm) {
+   if(vm != NULL){
+      unref_button_pixbufs(vm);
 
-   vm->feedbackImagePixbufs = malloc(NB_FB_COLORS * sizeof(GdkPixbuf * ));
-   if(vm->feedbackImagePixbufs == NULL){
-      free(vm->colorImagePixbufs);
       free(vm);
+   }
+}
+
+
+GtkWidget *
+create_window(const char *title, unsigned int width, unsigned int height) {
+   GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+   if(window == NULL)
       return NULL;
+
+   gtk_window_set_title(GTK_WINDOW(window), title);
+   gtk_window_set_default_size(GTK_WINDOW(window), width, height);
+   gtk_window_set_resizable(GTK_WINDOW(window), FALSE);
+   gtk_window_set_position(GTK_WINDOW(window), GTK_WIN_POS_CENTER);
+
+   return window;
+}
+
+
+static GdkPixbuf *create_asset_pixbuf(const char *path) {
+   assert(path != NULL);
+
+   for(unsigned int i = 0; i < NB_IMAGE_ASSETS; i++){
+      const ImageAsset *asset = &IMAGE_ASSETS[i];
+      if(!strcmp(asset->name, path))
+         return gdk_pixbuf_new_from_data(asset->pixels, GDK_COLORSPACE_RGB,
+                                         TRUE, 8, asset->width, asset->height,
+                                         asset->width * IMAGE_ASSET_CHANNELS,
+                                         NULL, NULL);
    }
 
-   for(unsigned int i = 0; i < NB_FB_COLORS; i++){
-      vm->feedbackImagePixbufs[i] = gdk_pixbuf_new_from_file(
-              FEEDBACK_IMAGE_FILENAMES[i], NULL);
-      if(vm->feedbackImagePixbufs[i] == NULL){
-         free(vm->feedbackImagePixbufs);
-         free(vm->colorImagePixbufs);
-         free(vm);
-         return NULL;
-      }
+   return NULL;
+}
+
+
+static int load_view_assets(void) {
+   if(assets.loaded)
+      return 0;
+
+   bool failed = false;
+
+   assets.winImage = create_asset_pixbuf(WIN_FILE_NAME);
+   failed |= assets.winImage == NULL;
+
+   assets.looseImage = create_asset_pixbuf(LOOSE_FILE_NAME);
+   failed |= assets.looseImage == NULL;
+
+   for(unsigned int i = 0; i < NB_PAWN_COLORS; i++){
+      assets.colorImages[i] = create_asset_pixbuf(COLOR_IMAGE_FILENAMES[i]);
+      failed |= assets.colorImages[i] == NULL;
    }
 
-   vm->historyCombinations = malloc(nbCombi * sizeof(GtkWidget * *));
-   if(vm->historyCombinations == NULL){
-      free(vm->feedbackImagePixbufs);
-      free(vm->colorImagePixbufs);
-      free(vm);
-      return NULL;
+   for(unsigned int i = 0; i < NB_FB_COLORS; i++){
+      assets.feedbackImages[i] = create_asset_pixbuf(FEEDBACK_IMAGE_FILENAMES[i]);
+      failed |= assets.feedbackImages[i] == NULL;
    }
 
-   for(unsigned int i = 0; i < nbCombi; i++){
-      vm->historyCombinations[i] = malloc(nbPawns * sizeof(GtkWidget * ));
-      if(vm->historyCombinations[i] == NULL){
-         for(unsigned int j = 0; j < i; j++)
-            free(vm->historyCombinations[j]);
-
-         free(vm->historyCombinations);
-         free(vm->feedbackImagePixbufs);
-         free(vm->colorImagePixbufs);
-         free(vm);
-         return NULL;
-      }
-      for(unsigned int j = 0; j < nbPawns; j++){
-         vm->historyCombinations[i][j] = create_button_with_pixbuf(
-                 get_color_image_pixbuf(vm, PAWN_DEFAULT), vm->bigButtonSize);
-         if(vm->historyCombinations[i][j] == NULL){
-            for(unsigned int k = 0; k < i; k++)
-               free(vm->historyCombinations[k]);
-
-            free(vm->historyCombinations);
-            free(vm->feedbackImagePixbufs);
-            free(vm->colorImagePixbufs);
-            free(vm);
-            return NULL;
-         }
-      }
+   assets.loaded = true;
+   if(failed){
+      destroy_view_assets();
+      return -1;
    }
 
-   vm->historyFeedbacks = malloc(nbCombi * sizeof(GtkWidget * *));
-   if(vm->historyFeedbacks == NULL){
-      for(unsigned int i = 0; i < nbCombi; i++)
-         free(vm->historyCombinations[i]);
+   return 0;
+}
 
-      free(vm->historyCombinations);
-      free(vm->feedbackImagePixbufs);
-      free(vm->colorImagePixbufs);
-      free(vm);
-      return NULL;
+
+void destroy_view_assets(void) {
+   if(!assets.loaded)
+      return;
+
+   if(assets.winImage != NULL)
+      g_object_unref(assets.winImage);
+
+   if(assets.looseImage != NULL)
+      g_object_unref(assets.looseImage);
+
+   for(unsigned int i = 0; i < NB_PAWN_COLORS; i++)
+      if(assets.colorImages[i] != NULL)
+         g_object_unref(assets.colorImages[i]);
+
+   for(unsigned int i = 0; i < NB_FB_COLORS; i++)
+      if(assets.feedbackImages[i] != NULL)
+         g_object_unref(assets.feedbackImages[i]);
+
+   assets = (ViewAssets) {0};
+}
+
+
+static int create_button_atlas(ViewMastermind *vm) {
+   assert(vm != NULL);
+
+   unsigned int sizes[NB_BUTTON_SIZES] = {vm->smallButtonSize,
+                                          vm->bigButtonSize,
+                                          vm->colorButtonSize,
+                                          vm->propositionButtonSize};
+   unsigned int width = 0;
+   unsigned int maxSize = 0;
+
+   for(unsigned int i = 0; i < NB_BUTTON_SIZES; i++){
+      width += sizes[i];
+      if(sizes[i] > maxSize)
+         maxSize = sizes[i];
    }
 
-   for(unsigned int i = 0; i < nbCombi; i++){
-      vm->historyFeedbacks[i] = malloc(nbPawns * sizeof(GtkWidget * ));
-      if(vm->historyFeedbacks[i] == NULL){
-         for(unsigned int j = 0; j < i; j++)
-            free(vm->historyFeedbacks[j]);
-
-         for(unsigned int j = 0; j < nbCombi; j++)
-            free(vm->historyCombinations[j]);
-
-         free(vm->historyFeedbacks);
-         free(vm->historyCombinations);
-         free(vm->feedbackImagePixbufs);
-         free(vm->colorImagePixbufs);
-         free(vm);
-         return NULL;
+   vm->buttonAtlas = gdk_pixbuf_new(GDK_COLORSPACE_RGB, TRUE, 8, width,
+                                    (NB_PAWN_COLORS + NB_FB_COLORS) * maxSize);
+   if(vm->buttonAtlas == NULL)
+      return -1;
+
+   // The corners of the shorter columns stay transparent.
+   gdk_pixbuf_fill(vm->buttonAtlas, 0);
+
+   bool failed = false;
+   unsigned int x = 0;
+
+   for(unsigned int i = 0; i < NB_BUTTON_SIZES; i++){
+      for(unsigned int j = 0; j < NB_PAWN_COLORS; j++){
+         vm->colorButtonPixbufs[i][j] = add_atlas_sprite(
+                 vm->buttonAtlas, assets.colorImages[j], x, j * sizes[i],
+                 sizes[i]);
+         failed |= vm->colorButtonPixbufs[i][j] == NULL;
       }
-      for(unsigned int j = 0; j < nbPawns; j++){
-         vm->historyFeedbacks[i][j] = create_button_with_pixbuf(
-                 get_feedback_image_pixbuf(vm, FB_DEFAULT),
-                 vm->smallButtonSize);
-         if(vm->historyFeedbacks[i][j] == NULL){
-            for(unsigned int k = 0; k < i; k++)
-               free(vm->historyFeedbacks[k]);
-
-            for(unsigned int k = 0; k < nbCombi; k++)
-               free(vm->historyCombinations[k]);
-
-            free(vm->historyFeedbacks);
-            free(vm->historyCombinations);
-            free(vm->feedbackImagePixbufs);
-            free(vm->colorImagePixbufs);
-            free(vm);
-            return NULL;
-         }
+
+      for(unsigned int j = 0; j < NB_FB_COLORS; j++){
+         vm->feedbackButtonPixbufs[i][j] = add_atlas_sprite(
+                 vm->buttonAtlas, assets.feedbackImages[j], x,
+                 (NB_PAWN_COLORS + j) * sizes[i], sizes[i]);
+         failed |= vm->feedbackButtonPixbufs[i][j] == NULL;
       }
+
+      x += sizes[i];
    }
 
-   return vm;
+   if(failed){
+      unref_button_pixbufs(vm);
+      return -1;
+   }
+
+   return 0;
 }
 
 
-void destroy_view_mastermind(ViewMastermind *vm) {
-   if(vm != NULL){
-      unsigned int nbCombi = get_nb_combinations(vm->mm);
+static GdkPixbuf *add_atlas_sprite(GdkPixbuf *atlas, GdkPixbuf *image,
+                                   unsigned int x, unsigned int y,
+                                   unsigned int size) {
+   assert(atlas != NULL && image != NULL);
 
-      if(vm->historyCombinations != NULL){
-         for(unsigned int i = 0; i < nbCombi; i++)
-            if(vm->historyCombinations[i] != NULL)
-               free(vm->historyCombinations[i]);
+   gdk_pixbuf_scale(image, atlas, x, y, size, size, x, y,
+                    (double) size / gdk_pixbuf_get_width(image),
+                    (double) size / gdk_pixbuf_get_height(image),
+                    GDK_INTERP_BILINEAR);
+
+   return gdk_pixbuf_new_subpixbuf(atlas, x, y, size, size);
+}
 
-         free(vm->historyCombinations);
-      }
 
-      if(vm->historyFeedbacks != NULL){
-         for(unsigned int i = 0; i < nbCombi; i++)
-            if(vm->historyFeedbacks[i] != NULL)
-               free(vm->historyFeedbacks[i]);
+static void unref_button_pixbufs(ViewMastermind *vm) {
+   assert(vm != NULL);
 
-         free(vm->historyFeedbacks);
+   for(unsigned int i = 0; i < NB_BUTTON_SIZES; i++){
+      for(unsigned int j = 0; j < NB_PAWN_COLORS; j++){
+         if(vm->colorButtonPixbufs[i][j] != NULL)
+            g_object_unref(vm->colorButtonPixbufs[i][j]);
+         vm->colorButtonPixbufs[i][j] = NULL;
       }
 
-      if(vm->colorImagePixbufs != NULL)
-         free(vm->colorImagePixbufs);
+      for(unsigned int j = 0; j < NB_FB_COLORS; j++){
+         if(vm->feedbackButtonPixbufs[i][j] != NULL)
+            g_object_unref(vm->feedbackButtonPixbufs[i][j]);
+         vm->feedbackButtonPixbufs[i][j] = NULL;
+      }
+   }
 
-      if(vm->feedbackImagePixbufs != NULL)
-         free(vm->feedbackImagePixbufs);
+   if(vm->buttonAtlas != NULL)
+      g_object_unref(vm->buttonAtlas);
+   vm->buttonAtlas = NULL;
+}
 
-      free(vm);
+
+static void get_board_cell(ViewMastermind *vm, unsigned int row,
+                           unsigned int column, GdkRectangle *cell) {
+   assert(vm != NULL && cell != NULL && row < get_nb_combinations(vm->mm) &&
+          column < 2 * get_nb_pawns(vm->mm));
+
+   unsigned int nbPawns = get_nb_pawns(vm->mm);
+   unsigned int pawnStep = vm->bigButtonSize + BOARD_SPACING;
+   unsigned int pegStep = vm->smallButtonSize + BOARD_SPACING;
+
+   cell->y = row * pawnStep + BOARD_SPACING / 2;
+   if(column < nbPawns){
+      cell->x = column * pawnStep + BOARD_SPACING / 2;
+      cell->width = cell->height = vm->bigButtonSize;
+   } else{
+      cell->x = nbPawns * pawnStep + (column - nbPawns) * pegStep +
+                BOARD_SPACING / 2;
+      cell->y += (vm->bigButtonSize - vm->smallButtonSize) / 2;
+      cell->width = cell->height = vm->smallButtonSize;
    }
 }
 
 
-GtkWidget *
-create_window(const char *title, unsigned int width, unsigned int height) {
-   GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-   if(window == NULL)
-      return NULL;
+static void set_board_cell(ViewMastermind *vm, unsigned int row,
+                           unsigned int column, uint8_t color) {
+   assert(vm != NULL);
 
-   gtk_window_set_title(GTK_WINDOW(window), title);
-   gtk_window_set_default_size(GTK_WINDOW(window), width, height);
-   gtk_window_set_resizable(GTK_WINDOW(window), FALSE);
-   gtk_window_set_position(GTK_WINDOW(window), GTK_WIN_POS_CENTER);
+   if(vm->boardCells[row][column] == color)
+      return;
+   vm->boardCells[row][column] = color;
 
-   return window;
+   GdkRectangle cell;
+   get_board_cell(vm, row, column, &cell);
+
+   if(vm->dirtyArea.width == 0)
+      vm->dirtyArea = cell;
+   else
+      gdk_rectangle_union(&vm->dirtyArea, &cell, &vm->dirtyArea);
 }
 
 
-void
-apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb, unsigned int size) {
+void apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb) {
    assert(button != NULL && pb != NULL);
 
-   GdkPixbuf *resizedPixbuf = gdk_pixbuf_scale_simple(pb, size, size,
-                                                      GDK_INTERP_BILINEAR);
-   GtkWidget *image = gtk_image_new_from_pixbuf(resizedPixbuf);
-   gtk_button_set_image(GTK_BUTTON(button), image);
+   // Only the pixbuf of the image changes, the button keeps its size.
+   GtkWidget *image = gtk_button_get_image(GTK_BUTTON(button));
+   if(image != NULL)
+      gtk_image_set_from_pixbuf(GTK_IMAGE(image), pb);
+   else
+      gtk_button_set_image(GTK_BUTTON(button), gtk_image_new_from_pixbuf(pb));
 }
 
 
-GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb, unsigned int size) {
+GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb) {
    assert(pb != NULL);
 
    GtkWidget *pButton = gtk_button_new();
    if(pButton == NULL)
       return NULL;
 
-   apply_pixbufs_to_button(pButton, pb, size);
+   apply_pixbufs_to_button(pButton, pb);
 
    return pButton;
 }
@@ -500,13 +733,19 @@ GtkWidget *
 create_image(const char *imagePath, unsigned int width, unsigned int height) {
    assert(imagePath != NULL);
 
-   GdkPixbuf *pb = gdk_pixbuf_new_from_file(imagePath, NULL);
+   GdkPixbuf *pb = create_asset_pixbuf(imagePath);
    if(pb == NULL)
       return NULL;
 
    GdkPixbuf *resizedPb = gdk_pixbuf_scale_simple(pb, width, height,
                                                   GDK_INTERP_BILINEAR);
+   g_object_unref(pb);
+   if(resizedPb == NULL)
+      return NULL;
+
+   // The image keeps its own reference on the pixbuf.
    GtkWidget *image = gtk_image_new_from_pixbuf(resizedPb);
+   g_object_unref(resizedPb);
 
    return image;
 }
@@ -518,9 +757,31 @@ void update_last_combination_images(ViewMastermind *vm, ModelMastermind *mm) {
    unsigned int index = get_current_index(mm);
 
    for(unsigned int i = 0; i < get_nb_pawns(mm); i++)
-      apply_pixbufs_to_button(vm->historyCombinations[index][i],
-                              vm->colorImagePixbufs[get_pawn_last_combination(
-                                      mm, i)], vm->bigButtonSize);
+      set_board_cell(vm, index, i, get_pawn_last_combination(mm, i));
+}
+
+
+void update_mastermind_scores_labels(ViewMastermind *vm) {
+   assert(vm != NULL);
+
+   SavedScores *scores = get_saved_scores(vm->mm);
+   unsigned long nbChanges = get_scores_changes(scores);
+   if(nbChanges == vm->scoresChanges)
+      return;
+
+   unsigned size;
+   char **SCORES_LABELS = get_scores_strings(scores, &size);
+
+   for(unsigned i = 0; i < MAX_SCORE_DISPLAYED; i++){
+      if(i < size){
+         gtk_label_set_text(GTK_LABEL(vm->scoresLabels[i]), SCORES_LABELS[i]);
+         gtk_widget_show(vm->scoresLabels[i]);
+      } else
+         gtk_widget_hide(vm->scoresLabels[i]);
+   }
+
+   free_scores_strings(SCORES_LABELS, size);
+   vm->scoresChanges = nbChanges;
 }
 
 
@@ -532,34 +793,96 @@ void udpate_last_feedback_images(ViewMastermind *vm, ModelMastermind *mm) {
    unsigned int nbCorrect = get_nb_correct_last_combination(mm);
    unsigned int nbMisplaced = get_nb_misplaced_last_combination(mm);
 
-   for(unsigned int i = 0; i < nbCorrect; i++)
-      apply_pixbufs_to_button(vm->historyFeedbacks[index][i],
-                              vm->feedbackImagePixbufs[FB_BLACK],
-                              vm->smallButtonSize);
+   for(unsigned int i = 0; i < nbPawns; i++){
+      FEEDBACK_COLOR color = FB_DEFAULT;
+      if(i < nbCorrect)
+         color = FB_BLACK;
+      else if(i < nbCorrect + nbMisplaced)
+         color = FB_WHITE;
+
+      set_board_cell(vm, index, nbPawns + i, color);
+   }
+}
+
 
-   for(unsigned int i = nbCorrect; i < nbCorrect + nbMisplaced; i++)
-      apply_pixbufs_to_button(vm->historyFeedbacks[index][i],
-                              vm->feedbackImagePixbufs[FB_WHITE],
-                              vm->smallButtonSize);
+void redraw_history_board(ViewMastermind *vm) {
+   assert(vm != NULL);
+
+   if(vm->dirtyArea.width == 0)
+      return;
 
-   for(unsigned int i = nbCorrect + nbMisplaced; i < nbPawns; i++)
-      apply_pixbufs_to_button(vm->historyFeedbacks[index][i],
-                              vm->feedbackImagePixbufs[FB_DEFAULT],
-                              vm->smallButtonSize);
+   // GTK merges the areas queued before the next frame in a single expose.
+   gtk_widget_queue_draw_area(vm->historyBoard, vm->dirtyArea.x,
+                              vm->dirtyArea.y, vm->dirtyArea.width,
+                              vm->dirtyArea.height);
+   vm->dirtyArea.width = 0;
 }
 
 
-GdkPixbuf *get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color) {
+void draw_history_board(ViewMastermind *vm, const GdkRectangle *area) {
+   assert(vm != NULL && area != NULL);
+
+   GdkWindow *window = gtk_widget_get_window(vm->historyBoard);
+   if(window == NULL)
+      return;
+
+   cairo_t *cr = gdk_cairo_create(window);
+   gdk_cairo_rectangle(cr, area);
+   cairo_clip(cr);
+
+   unsigned int nbCombi = get_nb_combinations(vm->mm);
+   unsigned int nbPawns = get_nb_pawns(vm->mm);
+   unsigned int rowStep = vm->bigButtonSize + BOARD_SPACING;
+
+   // Only the rows crossing the area are read from the model.
+   unsigned int firstRow = MAX(area->y, 0) / rowStep;
+   unsigned int lastRow = MIN((MAX(area->y + area->height, 0) + rowStep - 1) /
+                              rowStep, nbCombi);
+
+   for(unsigned int row = firstRow; row < lastRow; row++){
+      unsigned int nbCorrect = get_nb_correct_combination(vm->mm, row);
+      unsigned int nbMisplaced = get_nb_misplaced_combination(vm->mm, row);
+
+      for(unsigned int column = 0; column < 2 * nbPawns; column++){
+         GdkRectangle cell, visible;
+         get_board_cell(vm, row, column, &cell);
+         if(!gdk_rectangle_intersect(&cell, area, &visible))
+            continue;
+
+         GdkPixbuf *pb;
+         if(column < nbPawns)
+            pb = vm->colorButtonPixbufs[BIG_BUTTON]
+                    [get_pawn_combination(vm->mm, row, column)];
+         else if(column - nbPawns < nbCorrect)
+            pb = vm->feedbackButtonPixbufs[SMALL_BUTTON][FB_BLACK];
+         else if(column - nbPawns < nbCorrect + nbMisplaced)
+            pb = vm->feedbackButtonPixbufs[SMALL_BUTTON][FB_WHITE];
+         else
+            pb = vm->feedbackButtonPixbufs[SMALL_BUTTON][FB_DEFAULT];
+
+         gdk_cairo_set_source_pixbuf(cr, pb, cell.x, cell.y);
+         gdk_cairo_rectangle(cr, &visible);
+         cairo_fill(cr);
+      }
+   }
+
+   cairo_destroy(cr);
+}
+
+
+GdkPixbuf *
+get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color, BUTTON_SIZE size) {
    assert(vm != NULL);
 
-   return vm->colorImagePixbufs[color];
+   return vm->colorButtonPixbufs[size][color];
 }
 
 
-GdkPixbuf *get_feedback_image_pixbuf(ViewMastermind *vm, FEEDBACK_COLOR color) {
+GdkPixbuf *get_feedback_image_pixbuf(ViewMastermind *vm, FEEDBACK_COLOR color,
+                                     BUTTON_SIZE size) {
    assert(vm != NULL);
 
-   return vm->feedbackImagePixbufs[color];
+   return vm->feedbackButtonPixbufs[size][color];
 }
 
 
@@ -619,20 +942,6 @@ GtkWidget *get_main_menu_error_label(ViewMainMenu *vmm) {
 }
 
 
-unsigned int get_mastermind_proposition_button_size(ViewMastermind *vm) {
-   assert(vm != NULL);
-
-   return vm->propositionButtonSize;
-}
-
-
-unsigned int get_mastermind_color_button_size(ViewMastermind *vm) {
-   assert(vm != NULL);
-
-   return vm->colorButtonSize;
-}
-
-
 GtkWidget *get_mastermind_end_game_window(ViewMastermind *vm) {
    assert(vm != NULL);
 
@@ -643,14 +952,14 @@ GtkWidget *get_mastermind_end_game_window(ViewMastermind *vm) {
 GdkPixbuf *get_mastermind_win_image(ViewMastermind *vm) {
    assert(vm != NULL);
 
-   return vm->winImage;
+   return assets.winImage;
 }
 
 
 GdkPixbuf *get_mastermind_loose_image(ViewMastermind *vm) {
    assert(vm != NULL);
 
-   return vm->looseImage;
+   return assets.looseImage;
 }
 
 
@@ -717,10 +1026,10 @@ GtkWidget *get_mastermind_main_vbox(ViewMastermind *vm) {
 }
 
 
-GtkWidget *get_mastermind_history_table(ViewMastermind *vm) {
+GtkWidget *get_mastermind_history_board(ViewMastermind *vm) {
    assert(vm != NULL);
 
-   return vm->historyTable;
+   return vm->historyBoard;
 }
 
 
@@ -759,26 +1068,6 @@ GtkWidget *get_mastermind_score_hbox(ViewMastermind *vm) {
 }
 
 
-GtkWidget *
-get_mastermind_history_combination_button(ViewMastermind *vm, unsigned int i,
-                                          unsigned int j) {
-   assert(vm != NULL && i < get_nb_combinations(vm->mm) &&
-          j < get_nb_pawns(vm->mm));
-
-   return vm->historyCombinations[i][j];
-}
-
-
-GtkWidget *
-get_mastermind_history_feedback_button(ViewMastermind *vm, unsigned int i,
-                                       unsigned int j) {
-   assert(vm != NULL && i < get_nb_combinations(vm->mm) &&
-          j < get_nb_pawns(vm->mm));
-
-   return vm->historyFeedbacks[i][j];
-}
-
-
 GtkWidget *get_mastermind_score_label(ViewMastermind *vm) {
    assert(vm != NULL);
 
@@ -68,7 +68,18 @@
 /**
  * \brief Main menu logo path
  */
-#define LOGO_PATH "./images/title.png"
+#define LOGO_PATH "images/title.png"
+
+/**
+ * \brief Defines the sizes of the buttons showing a pawn.
+ */
+typedef enum {
+    SMALL_BUTTON,       /*!< History feedback button */
+    BIG_BUTTON,         /*!< History combination button */
+    COLOR_BUTTON,       /*!< Color selection button */
+    PROPOSITION_BUTTON, /*!< Proposition and feedback buttons */
+    NB_BUTTON_SIZES     /*!< Number of button sizes */
+} BUTTON_SIZE;
 
 /**
  * Declare the ViewMainMenu opaque type.
@@ -135,6 +146,17 @@ ViewMastermind *create_view_mastermind(ModelMastermind *mm);
 void destroy_view_mastermind(ViewMastermind *vm);
 
 
+/**
+ * \fn void destroy_view_assets(void)
+ * \brief Frees the images shared by the games, loaded by the first
+ * create_view_mastermind().
+ *
+ * \pre No game view exists.
+ * \post Memory allocated for the images is freed.
+ */
+void destroy_view_assets(void);
+
+
 /**
  * \fn GtkWidget *
  * create_window(const char *title, unsigned int width, unsigned int height)
@@ -155,36 +177,31 @@ create_window(const char *title, unsigned int width, unsigned int height);
 
 
 /**
- * \fn void apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb,
- * unsigned int size)
- * \brief Puts a pixbuf (image) in a button
+ * \fn void apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb)
+ * \brief Puts a pixbuf (image) in a button, reusing the image of the button
  *
  * \param button A pointer on the button that should contain the image
- * \param pb A pointer on the pixbuf that should be transformed into an image
- * \param size the size of the side of the button (square)
+ * \param pb A pointer on the pixbuf, already at the size of the button
  *
  * \pre button != NULL, pb != NULL
- * \post the button contains the given image and has the given size
+ * \post the button contains the given image
  */
-void
-apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb, unsigned int size);
+void apply_pixbufs_to_button(GtkWidget *button, GdkPixbuf *pb);
 
 
 /**
- * \fn GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb, unsigned int size)
+ * \fn GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb)
  * \brief creates a square button with an image in it
  *
- * \param pb A pointer on the pixbuf that should be transformed into an image
- * \param size The size of the side of the button (square)
+ * \param pb A pointer on the pixbuf, already at the size of the button
  *
  * \pre pb != NULL
- * \post The function returns a square button with the given size containing
- * the given image
+ * \post The function returns a square button containing the given image
  *
  * \return A pointer on the created button,
  *         NULL if fail
  */
-GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb, unsigned int size);
+GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb);
 
 
 /**
@@ -192,7 +209,7 @@ GtkWidget *create_button_with_pixbuf(GdkPixbuf *pb, unsigned int size);
  * unsigned int height)
  * \brief creates an image of a given width and height
  *
- * \param imagePath A string containing the path of the image in the files
+ * \param imagePath The path of the image packed in the game by mastermind-pack
  * \param width The width of the image
  * \param height The height of the image
  *
@@ -209,63 +226,108 @@ create_image(const char *imagePath, unsigned int width, unsigned int height);
 /**
  * \fn void update_last_combination_images(ViewMastermind *vm,
  * ModelMastermind *mm)
- * \brief Updates the buttons of the last combination to put the combination
- * images in it
+ * \brief Updates the history board to show the pawns of the last combination
  *
  * \param vm A pointer on the ViewMastermind structure
  * \param mm A pointer on the ModelMastermind structure
  *
  * \pre vm != NULL, mm != NULL
- * \post The buttons' image are updated
+ * \post The pawns of the last combination that changed will be redrawn by
+ * redraw_history_board()
  */
 void update_last_combination_images(ViewMastermind *vm, ModelMastermind *mm);
 
 
+/**
+ * \fn void update_mastermind_scores_labels(ViewMastermind *vm)
+ * \brief Updates the labels of the score window with the best scores, if
+ * they changed since the last update
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ *
+ * \pre vm != NULL
+ * \post The labels show the best scores, the others are hidden
+ */
+void update_mastermind_scores_labels(ViewMastermind *vm);
+
+
 /**
  * \fn void udpate_last_feedback_images(ViewMastermind *vm, ModelMastermind *mm)
- * \brief Updates the buttons of the last feedback to display the last given
- * feedback
+ * \brief Updates the history board to show the last given feedback
  *
  * \param vm A pointer on the ViewMastermind structure
  * \param mm A pointer on the ModelMastermind structure
  *
  * \pre vm != NULL, mm != NULL
- * \post The feedback buttons' image are updated
+ * \post The pegs of the last feedback that changed will be redrawn by
+ * redraw_history_board()
  */
 void udpate_last_feedback_images(ViewMastermind *vm, ModelMastermind *mm);
 
 
 /**
- * \fn GdkPixbuf *get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color)
- * \brief gets the pixbuf for a given color
+ * \fn void redraw_history_board(ViewMastermind *vm)
+ * \brief Asks the history board to redraw, in its next frame, the area of
+ * the cells changed since the last call
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ *
+ * \pre vm != NULL
+ * \post The changed cells will be redrawn, no cell is left to redraw
+ */
+void redraw_history_board(ViewMastermind *vm);
+
+
+/**
+ * \fn void draw_history_board(ViewMastermind *vm, const GdkRectangle *area)
+ * \brief Draws the cells of the history board crossing an area
+ *
+ * \param vm A pointer on the ViewMastermind structure
+ * \param area The area to draw, in board coordinates
+ *
+ * \pre vm != NULL, area != NULL
+ * \post The pawns and pegs of the area are drawn, if the board is realized
+ */
+void draw_history_board(ViewMastermind *vm, const GdkRectangle *area);
+
+
+/**
+ * \fn GdkPixbuf *get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color,
+ * BUTTON_SIZE size)
+ * \brief gets the pixbuf for a given color, scaled for a size of button
  *
  * \param vm A pointer on the ViewMastermind structure
  * \param color The color's pixbuf looked for
+ * \param size The size of the button showing the pixbuf
  *
  * \pre vm != NULL
  * \post The function returns the pixbuf from vm corresponding to the given
- * color
+ * color and size, owned by vm
  *
  * \return A pointer on the right pixbuf
  */
-GdkPixbuf *get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color);
+GdkPixbuf *
+get_color_image_pixbuf(ViewMastermind *vm, PAWN_COLOR color, BUTTON_SIZE size);
 
 
 /**
  * \fn GdkPixbuf *get_feedback_image_pixbuf(ViewMastermind *vm,
- * FEEDBACK_COLOR color)
- * \brief gets the pixbuf for the feedback buttons images
+ * FEEDBACK_COLOR color, BUTTON_SIZE size)
+ * \brief gets the pixbuf for the feedback buttons images, scaled for a size
+ * of button
  *
  * \param vm A pointer on the ViewMastermind structure
  * \param color The color's pixbuf looked for
+ * \param size The size of the button showing the pixbuf
  *
  * \pre vm != NULL
  * \post The function returns the pixbuf from vm corresponding to the given
- * color
+ * color and size, owned by vm
  *
  * \return A pointer on the right pixbuf
  */
-GdkPixbuf *get_feedback_image_pixbuf(ViewMastermind *vm, FEEDBACK_COLOR color);
+GdkPixbuf *get_feedback_image_pixbuf(ViewMastermind *vm, FEEDBACK_COLOR color,
+                                     BUTTON_SIZE size);
 
 
 /**
@@ -380,34 +442,6 @@ GtkWidget *get_main_menu_nb_pawns_label(ViewMainMenu *vmm);
 GtkWidget *get_main_menu_error_label(ViewMainMenu *vmm);
 
 
-/**
- * \fn unsigned int get_mastermind_proposition_button_size(ViewMastermind *vm)
- * \brief gets the size of the proposition button
- *
- * \param vm A pointer on the view of the mastermind structure
- *
- * \pre vm != NULL
- * \post The function returns the size stored in the field of vm
- *
- * \return The value of the size of the proposition button
- */
-unsigned int get_mastermind_proposition_button_size(ViewMastermind *vm);
-
-
-/**
- * \fn unsigned int get_mastermind_color_button_size(ViewMastermind *vm)
- * \brief gets the size of the color button
- *
- * \param vm A pointer on the view of the mastermind structure
- *
- * \pre vm != NULL
- * \post The function returns the size stored in the field of vm
- *
- * \return The value of the size of the color button
- */
-unsigned int get_mastermind_color_button_size(ViewMastermind *vm);
-
-
 /**
  * \fn GtkWidget *get_mastermind_end_game_window(ViewMastermind *vm)
  * \brief gets the widget of the end of the game window
@@ -577,17 +611,17 @@ GtkWidget *get_mastermind_main_vbox(ViewMastermind *vm);
 
 
 /**
- * \fn GtkWidget *get_mastermind_history_table(ViewMastermind *vm)
- * \brief gets the widget of the mastermind history table
+ * \fn GtkWidget *get_mastermind_history_board(ViewMastermind *vm)
+ * \brief gets the drawing area of the mastermind history
  *
  * \param vm A pointer on the view of the mastermind structure
  *
  * \pre vm != NULL
  * \post The function returns the pointer stored in the field of vm
  *
- * \return A pointer on the widget of the mastermind history table
+ * \return A pointer on the drawing area of the mastermind history
  */
-GtkWidget *get_mastermind_history_table(ViewMastermind *vm);
+GtkWidget *get_mastermind_history_board(ViewMastermind *vm);
 
 
 /**
@@ -686,45 +720,4 @@ GtkWidget *get_mastermind_score_label(ViewMastermind *vm);
  */
 void set_score_label_text(GtkWidget *label, char *string);
 
-
-/**
- * \fn GtkWidget *get_mastermind_history_combination_button(ViewMastermind
- * *vm, unsigned int i, unsigned int j)
- * \brief gets the widget of the history combination button of given coordinates
- *
- * \param vm A pointer on the view of the mastermind structure
- * \param i abscissa
- * \param j ordinate
- *
- * \pre vm != NULL
- * \post The function returns the pointer stored in the field of vm
- *
- * \return A pointer on the widget of the history combination button of given
- * coordinates
- */
-GtkWidget *
-get_mastermind_history_combination_button(ViewMastermind *vm, unsigned int i,
-                                          unsigned int j);
-
-
-/**
- * \fn GtkWidget *get_mastermind_history_feedback_button(ViewMastermind
- * *vm, unsigned int i, unsigned int j)
- * \brief gets the widget of the feedback combination button of given
- * coordinates
- *
- * \param vm A pointer on the view of the mastermind structure
- * \param i abscissa
- * \param j ordinate
- *
- * \pre vm != NULL
- * \post The function returns the pointer stored in the field of vm
- *
- * \return A pointer on the widget of the feedback combination button of given
- * coordinates
- */
-GtkWidget *
-get_mastermind_history_feedback_button(ViewMastermind *vm, unsigned int i,
-                                       unsigned int j);
-
 #endif //__VIEW_MASTERMIND__